@@ -5,10 +5,13 @@
 #include <QHBoxLayout>
 #include <QSplitter>
 #include <QListWidget>
-#include <QListView>
+#include <QAbstractItemView>
+#include <QItemSelectionModel>
 #include <QAbstractListModel>
 #include <QSortFilterProxyModel>
 #include <QLineEdit>
+#include <QComboBox>
+#include <QCollator>
 #include <QPushButton>
 #include <QLabel>
 #include <QStatusBar>
@@ -25,6 +28,8 @@
 #include <QHash>
 #include <QSet>
 #include <QPixmap>
+#include <QImage>
+#include <QDataStream>
 #include <QPainter>
 #include <QFont>
 #include <QColor>
@@ -46,41 +51,613 @@
 #include <QGraphicsDropShadowEffect>
 #include <QToolButton>
 #include <QStackedWidget>
+#include <QTcpSocket>
+#include <QTcpServer>
+#include <QHostInfo>
+#include <QQueue>
+#include <QHostAddress>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QLockFile>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QGridLayout>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QMenu>
+#include <QDialog>
+#include <QFormLayout>
+#include <QDateTimeEdit>
+#include <QDialogButtonBox>
+#include <QEventLoop>
+#include <QTextStream>
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QStaticText>
+#include <QAbstractEventDispatcher>
+#include <QPixmapCache>
+#include <QProxyStyle>
+#include <QStyleFactory>
+#include <QStyleOption>
+#include <QToolTip>
 #include <QtGlobal>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
 #endif
 
 #include <mpv/client.h>
+#include <mpv/render.h>
+#include <mpv/stream_cb.h>
+#include <zlib.h>
 
 #include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <vector>
 
 static const char *PLAYLIST_URL = "https://m3u.work/jwuF5FPp.m3u";
 static const int MAX_DOWNLOAD_SIZE = 10 * 1024 * 1024;
 static const int PLAYLIST_TIMEOUT_MS = 15000;
 static const int IMAGE_TIMEOUT_MS = 6000;
-static const int MAX_CONCURRENT_DOWNLOADS = 8;
 static const int DEBOUNCE_MS = 150;
 static const int OSD_DISPLAY_MS = 3500;
+static const int OSD_FADE_MS = 250;
+static const int OSD_FADE_STEP_MS = 33;
+static const int OSD_OVERLAY_ID = 0;
 static const int AUTOHIDE_MS = 3000;
 static const int MAX_NAME_LEN = 200;
 static const int STATUS_CHECK_INTERVAL_MS = 30000;
+static const int PROBE_TIMEOUT_MS = 5000;
+static const int MAX_CONCURRENT_PROBES = 4;
+static const int PROBE_PUMP_INTERVAL_MS = 250;
+static const int PROBE_ALIVE_TTL_MS = 10 * 60 * 1000;
+static const int PROBE_DEAD_TTL_MS = 3 * 60 * 1000;
+static const int PROBE_REPAINT_MS = 500;
+static const int STALL_RECONNECT_MS = 6000;
+static const int RECONNECT_BASE_MS = 1000;
+static const int MAX_RECONNECT_ATTEMPTS = 3;
+static const int STABLE_PLAYBACK_MS = 30000;
+static const qint64 QUALITY_LOG_MAX_BYTES = 1024 * 1024;
+static const int MOSAIC_BUDGET_INTERVAL_MS = 2000;
+static const int MOSAIC_CPU_BUDGET_PERCENT = 75;
+static const int MOSAIC_CPU_RELEASE_PERCENT = 45;
+static const qint64 MOSAIC_MEMORY_BUDGET = 1536LL * 1024 * 1024;
+static const int DEFAULT_FRAME_INTERVAL_MS = 16;
+static const int FETCH_RETRY_MS = 2000;
+static const int FETCH_MAX_FAILURES = 5;
+static const int TIMESHIFT_DEFAULT_CAPACITY_MB = 2048;
+static const int TIMESHIFT_INDEX_INTERVAL_MS = 500;
+static const int TIMESHIFT_LIVE_MARGIN_MS = 3000;
+static const int TIMESHIFT_SEEK_STEP_MS = 30000;
+static const int RECORD_DRAIN_INTERVAL_MS = 100;
+static const qint64 RECORD_MAX_BACKLOG = 64 * 1024 * 1024;
+static const int RECORD_DEFAULT_DISK_MBPS = 20;
+static const int RECORD_SCHEDULE_CHECK_MS = 1000;
+static const int DEFAULT_ZAP_LATENCY_MS = 5000;
+static const int PROFILER_RING_SIZE = 8192;
+static const int PROFILER_WINDOW_MS = 5000;
+static const int PROFILER_REFRESH_MS = 500;
+static const int PROFILER_LAG_INTERVAL_MS = 50;
+static const int NET_HTTP1_HOST_LIMIT = 6;
+static const int NET_HTTP2_HOST_LIMIT = 32;
+static const int NET_STALL_TIMEOUT_MS = 15000;
+static const int LOGO_MAX_IN_FLIGHT = 64;
+static const int LOGO_WIDTH = 52;
+static const int LOGO_HEIGHT = 42;
+static const int LOGO_ATLAS_PAGE_SIZE = 2048;
+static const int LOGO_ATLAS_MAX_PAGES = 8;
+static const quint32 LOGO_ATLAS_MAGIC = 0x4c54564c;
+static const int LOGO_INITIAL_HOST_LIMIT = 2;
+static const int LOGO_SLOW_MS = 1500;
+static const int LOGO_MAX_RETRIES = 3;
+static const int LOGO_RETRY_BASE_MS = 1000;
+static const qint64 LOGO_FAILURE_TTL_MS = 6LL * 60 * 60 * 1000;
+static const qint64 LOGO_FAILURE_MAX_TTL_MS = 7LL * 24 * 60 * 60 * 1000;
+static const int RELAY_MANIFEST_TTL_MS = 1000;
+static const qint64 RELAY_CACHE_BYTES = 64 * 1024 * 1024;
+static const int RELAY_MAX_RETRIES = 2;
+static const int RELAY_RETRY_DELAY_MS = 500;
+static const qint64 RELAY_MAX_CLIENT_BACKLOG = 8 * 1024 * 1024;
+static const qint64 RELAY_MAX_BUFFERED_BYTES = 16 * 1024 * 1024;
+static const qint64 RELAY_PIPE_BUFFER_BYTES = 1024 * 1024;
+static const int HISTORY_COMPACT_MIN_RECORDS = 4096;
+static const int HISTORY_RECENT_LIMIT = 50;
+static const int HISTORY_WATCH_FLUSH_MS = 60000;
+static const int EPG_TIMEOUT_MS = 60000;
+static const int EPG_MAX_DOWNLOAD_SIZE = 256 * 1024 * 1024;
+static const qint64 EPG_PAST_MS = 2LL * 60 * 60 * 1000;
+static const qint64 EPG_MIN_SPAN_MS = 24LL * 60 * 60 * 1000;
+static const qint64 EPG_MAX_SPAN_MS = 8LL * 24 * 60 * 60 * 1000;
+static const qint64 EPG_SLOT_MS = 30LL * 60 * 1000;
+static const int EPG_ROW_HEIGHT = 44;
+static const int EPG_HEADER_HEIGHT = 28;
+static const int EPG_NAME_WIDTH = 200;
+static const int EPG_PIXELS_PER_MINUTE = 5;
+static const int EPG_TEXT_CACHE_SIZE = 4096;
+static const int EPG_NOW_REFRESH_MS = 30000;
+static const int PREVIEW_WIDTH = 75;
+static const int PREVIEW_HEIGHT = 42;
+static const int PREVIEW_GRAB_TIMEOUT_MS = 8000;
+static const int PREVIEW_MIN_INTERVAL_MS = 1000;
+static const int PREVIEW_RECHECK_MS = 30000;
+static const int PREVIEW_CPU_PERCENT = 10;
+static const qint64 PREVIEW_MAX_AGE_MS = 5 * 60 * 1000;
+static const int PREVIEW_CACHE_SIZE = 512;
+static const int GOVERNOR_IDLE_MS = 5 * 60 * 1000;
+static const int GOVERNOR_SHED_DELAY_MS = 2 * 60 * 1000;
+static const qint64 GOVERNOR_SHED_RSS_BYTES = 150 * 1024 * 1024;
+static const int GOVERNOR_RSS_SETTLE_MS = 2000;
+static const int PREWARM_HOVER_MS = 150;
+static const int PREWARM_PER_SECOND = 4;
+static const int PREWARM_MAX_IDLE_HOSTS = 6;
+static const int PREWARM_IDLE_MS = 60000;
+static const int PREWARM_MANIFEST_TTL_MS = 3000;
+static const qint64 HLS_MIN_SAMPLE_BYTES = 64 * 1024;
+static const int HLS_ESTIMATE_WEIGHT_PERCENT = 30;
+static const int HLS_START_PERCENT = 50;
+static const int HLS_SAFETY_PERCENT = 80;
+static const int HLS_UPSWITCH_BUFFER_MS = 8000;
+static const int HLS_SWITCH_HOLD_MS = 10000;
+static const int HLS_SWITCH_SETTLE_MS = 3000;
+static const int HLS_ADAPT_INTERVAL_MS = 2000;
+static const int HLS_RATE_SAMPLE_MS = 1000;
+// What the playlist parser fills in for entries without a name or group.
+static const char UNNAMED_CHANNEL[] = "Unknown";
+static const char DEFAULT_CATEGORY[] = "Others";
+
+struct StartupOptions {
+    QString playlistUrl;
+    bool softwareRender = false;
+    double renderScale = 1.0;
+    QElapsedTimer launchClock;
+};
 
 struct Channel {
     QString name;
     QString category;
     QString logoUrl;
     QString streamUrl;
+    QString tvgId;
+    int number = 0;
+    bool radio = false;
+};
+
+struct WatchStat {
+    int plays = 0;
+    qint64 lastWatched = 0;
+    qint64 watchMs = 0;
+};
+
+static const mpv_node *mpvNodeMapValue(const mpv_node *node, const char *key) {
+    if (!node || node->format != MPV_FORMAT_NODE_MAP || !node->u.list) return nullptr;
+    for (int i = 0; i < node->u.list->num; ++i) {
+        if (strcmp(node->u.list->keys[i], key) == 0) return &node->u.list->values[i];
+    }
+    return nullptr;
+}
+
+// Channels that share a tvg-id, or failing that a name once bracketed tags and
+// quality suffixes are dropped, are treated as mirrors of each other. Entries
+// the parser had to name UNNAMED_CHANNEL share nothing but the placeholder.
+static QString mirrorKey(const Channel &ch) {
+    if (!ch.tvgId.isEmpty()) return "id:" + ch.tvgId.toLower();
+    if (ch.name == QLatin1String(UNNAMED_CHANNEL)) return QString();
+    static const QRegularExpression reTags("\\[[^\\]]*\\]|\\([^)]*\\)");
+    static const QRegularExpression reQuality("\\b(fhd|uhd|hd|sd|4k|hevc|h265|backup|\\d{3,4}p)\\b");
+    static const QRegularExpression reNonAlnum("[^\\p{L}\\p{N}]");
+    QString n = ch.name.toLower();
+    n.remove(reTags);
+    n.remove(reQuality);
+    n.remove(reNonAlnum);
+    return n.isEmpty() ? QString() : "name:" + n;
+}
+
+// Always-on scoped timing. Each thread appends samples to its own fixed-size
+// ring with one atomic store, so instrumented code never takes a lock;
+// readers copy every ring when the overlay refreshes or a trace is exported
+// and drop whatever was overwritten while they were copying.
+class Profiler {
+public:
+    struct Sample {
+        const char *name;
+        qint64 startNs;
+        qint64 durationNs;
+        int thread;
+    };
+
+    static qint64 nowNs() { return clock().nsecsElapsed(); }
+
+    static void record(const char *name, qint64 startNs, qint64 durationNs) {
+        Ring *ring = localRing();
+        quint64 head = ring->head.load(std::memory_order_relaxed);
+        Sample &s = ring->samples[head % PROFILER_RING_SIZE];
+        s.name = name;
+        s.startNs = startNs;
+        s.durationNs = durationNs;
+        s.thread = ring->id;
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    static QVector<Sample> snapshot(qint64 sinceNs) {
+        QVector<Sample> out;
+        QMutexLocker lock(&registryMutex());
+        const QVector<Ring *> &all = rings();
+        for (int r = 0; r < all.size(); ++r) {
+            Ring *ring = all[r];
+            quint64 head = ring->head.load(std::memory_order_acquire);
+            quint64 first = head > quint64(PROFILER_RING_SIZE) ? head - PROFILER_RING_SIZE : 0;
+            QVector<Sample> copy;
+            copy.reserve(static_cast<int>(head - first));
+            for (quint64 i = first; i < head; ++i) copy.append(ring->samples[i % PROFILER_RING_SIZE]);
+            quint64 after = ring->head.load(std::memory_order_acquire);
+            // The writer may already be filling slot `after`, which is the
+            // same slot as index after - PROFILER_RING_SIZE.
+            quint64 valid = after >= quint64(PROFILER_RING_SIZE) ? after - PROFILER_RING_SIZE + 1 : 0;
+            for (int i = 0; i < copy.size(); ++i) {
+                if (first + quint64(i) < valid || copy[i].startNs < sinceNs) continue;
+                out.append(copy[i]);
+            }
+        }
+        return out;
+    }
+
+    static QHash<int, QString> threadNames() {
+        QHash<int, QString> names;
+        QMutexLocker lock(&registryMutex());
+        const QVector<Ring *> &all = rings();
+        for (int i = 0; i < all.size(); ++i) names.insert(all[i]->id, all[i]->threadName);
+        return names;
+    }
+
+    // Chrome's trace-event format, loadable in chrome://tracing or Perfetto.
+    static bool exportChromeTrace(const QString &path) {
+        QVector<Sample> samples = snapshot(0);
+        QHash<int, QString> names = threadNames();
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+        QByteArray json = "{\"traceEvents\":[\n";
+        bool first = true;
+        for (auto it = names.constBegin(); it != names.constEnd(); ++it) {
+            QString name = it.value();
+            name.replace('\\', "\\\\").replace('"', "\\\"");
+            json += QString("%1{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%2,\"args\":{\"name\":\"%3\"}}")
+                        .arg(first ? "" : ",\n").arg(it.key()).arg(name).toUtf8();
+            first = false;
+        }
+        for (int i = 0; i < samples.size(); ++i) {
+            const Sample &s = samples[i];
+            json += first ? "" : ",\n";
+            json += "{\"name\":\"";
+            json += s.name;
+            json += "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + QByteArray::number(s.thread) +
+                    ",\"ts\":" + QByteArray::number(s.startNs / 1000.0, 'f', 3) +
+                    ",\"dur\":" + QByteArray::number(s.durationNs / 1000.0, 'f', 3) + "}";
+            first = false;
+        }
+        json += "\n]}\n";
+        return file.write(json) == json.size();
+    }
+
+private:
+    struct Ring {
+        Sample samples[PROFILER_RING_SIZE];
+        std::atomic<quint64> head{0};
+        std::atomic<bool> inUse{true};
+        int id = 0;
+        QString threadName;
+    };
+
+    // Releases the calling thread's ring when it exits so the next thread
+    // can take it over instead of growing the registry.
+    struct RingHolder {
+        Ring *ring = nullptr;
+        ~RingHolder() {
+            if (ring) ring->inUse.store(false, std::memory_order_release);
+        }
+    };
+
+    static QElapsedTimer &clock() {
+        static QElapsedTimer timer = startedTimer();
+        return timer;
+    }
+
+    static QElapsedTimer startedTimer() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }
+
+    static QMutex &registryMutex() {
+        static QMutex mutex;
+        return mutex;
+    }
+
+    static QVector<Ring *> &rings() {
+        static QVector<Ring *> all;
+        return all;
+    }
+
+    static Ring *localRing() {
+        static thread_local RingHolder holder;
+        if (!holder.ring) holder.ring = acquireRing();
+        return holder.ring;
+    }
+
+    static Ring *acquireRing() {
+        QThread *thread = QThread::currentThread();
+        QMutexLocker lock(&registryMutex());
+        QVector<Ring *> &all = rings();
+        Ring *ring = nullptr;
+        for (int i = 0; i < all.size() && !ring; ++i) {
+            if (!all[i]->inUse.load(std::memory_order_acquire)) ring = all[i];
+        }
+        if (ring) {
+            ring->inUse.store(true, std::memory_order_relaxed);
+            ring->head.store(0, std::memory_order_relaxed);
+        } else {
+            ring = new Ring;
+            ring->id = all.size() + 1;
+            all.append(ring);
+        }
+        ring->threadName = qApp && thread == qApp->thread() ? QString("GUI") : thread->objectName();
+        if (ring->threadName.isEmpty()) ring->threadName = QString("Thread %1").arg(ring->id);
+        return ring;
+    }
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char *name) : m_name(name), m_start(Profiler::nowNs()) {}
+    ~ProfileScope() { Profiler::record(m_name, m_start, Profiler::nowNs() - m_start); }
+
+private:
+    const char *m_name;
+    qint64 m_start;
+};
+
+static bool isAudioStreamUrl(const QUrl &url) {
+    static const QStringList audioSuffixes = {"mp3", "aac", "ogg", "opus", "m4a", "flac"};
+    return audioSuffixes.contains(QFileInfo(url.path()).suffix().toLower());
+}
+
+// Parses an extended M3U playlist. Entries whose URL is not a stream scheme
+// mpv can open are dropped.
+static QVector<Channel> parseM3uChannels(const QByteArray &data) {
+    QVector<Channel> channels;
+    QString text = QString::fromUtf8(data);
+    QStringList lines = text.split(QRegularExpression("[\\r\\n]+"), QString::SkipEmptyParts);
+
+    QRegularExpression reExtInf("^#EXTINF\\s*:\\s*(-?\\d+)\\s*(.*),\\s*(.*)$");
+    QRegularExpression reLogo("tvg-logo\\s*=\\s*\"([^\"]*)\"");
+    QRegularExpression reGroup("group-title\\s*=\\s*\"([^\"]*)\"");
+    QRegularExpression reTvgId("tvg-id\\s*=\\s*\"([^\"]*)\"");
+    QRegularExpression reChno("tvg-chno\\s*=\\s*\"([^\"]*)\"");
+    QRegularExpression reRadio("radio\\s*=\\s*\"(?:true|1)\"", QRegularExpression::CaseInsensitiveOption);
+
+    Channel pending;
+    bool hasPending = false;
+
+    for (int i = 0; i < lines.size(); ++i) {
+        QString line = lines[i].trimmed();
+        if (line.isEmpty()) continue;
+
+        if (line.startsWith("#EXTINF")) {
+            QRegularExpressionMatch match = reExtInf.match(line);
+            pending = Channel();
+            if (match.hasMatch()) {
+                QString attrs = match.captured(2);
+                pending.name = match.captured(3).trimmed();
+                if (pending.name.length() > MAX_NAME_LEN)
+                    pending.name = pending.name.left(MAX_NAME_LEN);
+
+                QRegularExpressionMatch logoMatch = reLogo.match(attrs);
+                if (logoMatch.hasMatch()) pending.logoUrl = logoMatch.captured(1).trimmed();
+
+                QRegularExpressionMatch groupMatch = reGroup.match(attrs);
+                if (groupMatch.hasMatch()) pending.category = groupMatch.captured(1).trimmed();
+
+                QRegularExpressionMatch idMatch = reTvgId.match(attrs);
+                if (idMatch.hasMatch()) pending.tvgId = idMatch.captured(1).trimmed();
+
+                QRegularExpressionMatch chnoMatch = reChno.match(attrs);
+                if (chnoMatch.hasMatch()) pending.number = qMax(0, chnoMatch.captured(1).trimmed().toInt());
+
+                pending.radio = reRadio.match(attrs).hasMatch();
+            } else {
+                int commaIdx = line.lastIndexOf(',');
+                if (commaIdx >= 0) {
+                    pending.name = line.mid(commaIdx + 1).trimmed();
+                    if (pending.name.length() > MAX_NAME_LEN)
+                        pending.name = pending.name.left(MAX_NAME_LEN);
+                }
+            }
+
+            if (pending.category.isEmpty()) pending.category = DEFAULT_CATEGORY;
+            if (pending.name.isEmpty()) pending.name = UNNAMED_CHANNEL;
+            hasPending = true;
+        } else if (!line.startsWith("#")) {
+            if (hasPending) {
+                QUrl streamUrl(line);
+                if (streamUrl.isValid()) {
+                    QString scheme = streamUrl.scheme().toLower();
+                    if (scheme == "http" || scheme == "https" || scheme == "rtsp" ||
+                        scheme == "rtmp" || scheme == "mms" || scheme == "mmsh") {
+                        pending.streamUrl = line;
+                        if (!pending.radio) {
+                            pending.radio = isAudioStreamUrl(streamUrl) ||
+                                            pending.category.contains("radio", Qt::CaseInsensitive);
+                        }
+                        channels.append(pending);
+                    }
+                }
+                hasPending = false;
+            }
+        }
+    }
+    return channels;
+}
+
+// The guide URL is an attribute of the #EXTM3U header. Some playlists list
+// several guides separated by commas; the first one is used.
+static QString parseM3uGuideUrl(const QByteArray &data) {
+    int eol = data.indexOf('\n');
+    QString header = QString::fromUtf8(eol < 0 ? data : data.left(eol)).trimmed();
+    if (!header.startsWith("#EXTM3U")) return QString();
+    QRegularExpressionMatch match = QRegularExpression("(?:url-tvg|x-tvg-url)\\s*=\\s*\"([^\"]*)\"").match(header);
+    if (!match.hasMatch()) return QString();
+    return match.captured(1).section(',', 0, 0).trimmed();
+}
+
+struct Programme {
+    qint64 start = 0;
+    qint64 stop = 0;
+    QString title;
+};
+
+struct EpgGuide {
+    QHash<QString, QVector<Programme> > programmes;  // by XMLTV channel id, sorted by start
+    QHash<QString, QString> idByName;                 // lower-case display name -> channel id
+    qint64 end = 0;
 };
 
+typedef QSharedPointer<const EpgGuide> EpgGuidePtr;
+Q_DECLARE_METATYPE(EpgGuidePtr)
+
+// Programmes for a channel, matched by tvg-id first and display name second.
+static const QVector<Programme> *guideProgrammes(const EpgGuide &guide, const QString &tvgId, const QString &name) {
+    QString id = tvgId;
+    if (id.isEmpty() || !guide.programmes.contains(id)) id = guide.idByName.value(name.toLower());
+    QHash<QString, QVector<Programme> >::const_iterator it = guide.programmes.constFind(id);
+    return it == guide.programmes.constEnd() ? nullptr : &*it;
+}
+
+// XMLTV times look like "20240101203000 +0100".
+static qint64 parseXmltvTime(const QString &text) {
+    if (text.size() < 14) return 0;
+    bool ok = true;
+    auto field = [&text, &ok](int pos, int len) {
+        bool fieldOk = false;
+        int v = text.mid(pos, len).toInt(&fieldOk);
+        ok = ok && fieldOk;
+        return v;
+    };
+    QDate date(field(0, 4), field(4, 2), field(6, 2));
+    QTime time(field(8, 2), field(10, 2), field(12, 2));
+    if (!ok || !date.isValid() || !time.isValid()) return 0;
+    qint64 ms = QDateTime(date, time, Qt::UTC).toMSecsSinceEpoch();
+    QString zone = text.mid(14).trimmed();
+    if (zone.size() == 5 && (zone.at(0) == '+' || zone.at(0) == '-')) {
+        qint64 offset = (zone.mid(1, 2).toInt() * 60 + zone.mid(3, 2).toInt()) * 60000LL;
+        ms -= zone.at(0) == '+' ? offset : -offset;
+    }
+    return ms;
+}
+
+// Keeps programmes that end after windowStart and start within
+// EPG_MAX_SPAN_MS of it. Returns early, with what it has so far, if the
+// calling thread is asked to stop.
+// Inflates a gzip body, as most url-tvg guides are served (.xml.gz). Returns
+// false for corrupt data or once the output would pass maxSize.
+static bool gunzip(const QByteArray &data, qint64 maxSize, QByteArray *out) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) return false;
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    zs.avail_in = static_cast<uInt>(data.size());
+    out->clear();
+    char buf[64 * 1024];
+    int ret = Z_OK;
+    while (ret == Z_OK) {
+        zs.next_out = reinterpret_cast<Bytef *>(buf);
+        zs.avail_out = sizeof(buf);
+        ret = inflate(&zs, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END) break;
+        out->append(buf, static_cast<int>(sizeof(buf) - zs.avail_out));
+        if (out->size() > maxSize) {
+            ret = Z_MEM_ERROR;
+            break;
+        }
+        // Concatenated gzip members continue after the end of the first.
+        if (ret == Z_STREAM_END && zs.avail_in > 0 && inflateReset(&zs) == Z_OK) ret = Z_OK;
+    }
+    inflateEnd(&zs);
+    return ret == Z_STREAM_END;
+}
+
+static EpgGuide *parseXmltv(const QByteArray &data, qint64 windowStart) {
+    EpgGuide *guide = new EpgGuide;
+    qint64 windowEnd = windowStart + EPG_MAX_SPAN_MS;
+    QXmlStreamReader xml(data);
+    int elements = 0;
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement) continue;
+        if ((++elements & 4095) == 0 && QThread::currentThread()->isInterruptionRequested()) break;
+        if (xml.name() == QLatin1String("channel")) {
+            QString id = xml.attributes().value("id").toString();
+            while (xml.readNextStartElement()) {
+                if (xml.name() != QLatin1String("display-name")) {
+                    xml.skipCurrentElement();
+                    continue;
+                }
+                QString name = xml.readElementText().trimmed().toLower();
+                if (!name.isEmpty() && !guide->idByName.contains(name)) guide->idByName.insert(name, id);
+            }
+        } else if (xml.name() == QLatin1String("programme")) {
+            QXmlStreamAttributes attrs = xml.attributes();
+            Programme programme;
+            programme.start = parseXmltvTime(attrs.value("start").toString());
+            programme.stop = parseXmltvTime(attrs.value("stop").toString());
+            QString channel = attrs.value("channel").toString();
+            while (xml.readNextStartElement()) {
+                if (xml.name() == QLatin1String("title") && programme.title.isEmpty()) {
+                    programme.title = xml.readElementText().trimmed();
+                } else {
+                    xml.skipCurrentElement();
+                }
+            }
+            if (programme.stop <= programme.start) continue;
+            if (programme.stop <= windowStart || programme.start >= windowEnd) continue;
+            guide->programmes[channel].append(programme);
+            guide->end = qMax(guide->end, qMin(programme.stop, windowEnd));
+        }
+    }
+    for (auto it = guide->programmes.begin(); it != guide->programmes.end(); ++it) {
+        std::sort(it->begin(), it->end(), [](const Programme &a, const Programme &b) { return a.start < b.start; });
+    }
+    return guide;
+}
+
 enum ChannelRoles {
     NameRole = Qt::UserRole + 1,
     CategoryRole,
     LogoUrlRole,
     StreamUrlRole,
-    IndexRole
+    IndexRole,
+    TvgIdRole,
+    RadioRole
+};
+
+// What an entry in the category list stands for. Kept apart from the entry's
+// text so a playlist group titled "Favorites" or "All" stays an ordinary group.
+enum CategoryKind {
+    GroupCategory,
+    AllCategories,
+    FavoritesCategory,
+    RecentCategory
 };
 
 class ChannelModel : public QAbstractListModel {
@@ -110,6 +687,8 @@ public:
             case LogoUrlRole: return ch.logoUrl;
             case StreamUrlRole: return ch.streamUrl;
             case IndexRole: return index.row();
+            case TvgIdRole: return ch.tvgId;
+            case RadioRole: return ch.radio;
             default: return QVariant();
         }
     }
@@ -121,6 +700,8 @@ public:
         r[LogoUrlRole] = "logoUrl";
         r[StreamUrlRole] = "streamUrl";
         r[IndexRole] = "channelIndex";
+        r[TvgIdRole] = "tvgId";
+        r[RadioRole] = "radio";
         return r;
     }
 
@@ -130,319 +711,4933 @@ private:
     QVector<Channel> m_channels;
 };
 
-class CategoryFilterProxy : public QSortFilterProxyModel {
+// One QNetworkAccessManager shared by everything on the GUI thread, so
+// keep-alive connections and TLS sessions are reused between the playlist,
+// probes and logos. request() is also used by the worker-thread managers so
+// every request gets the same redirect policy, HTTP/2 negotiation and
+// transfer timeout.
+class NetworkLayer : public QObject {
     Q_OBJECT
 public:
-    explicit CategoryFilterProxy(QObject *parent = nullptr) : QSortFilterProxyModel(parent) {}
+    explicit NetworkLayer(QObject *parent = nullptr) : QObject(parent) {
+        m_nam = new QNetworkAccessManager(this);
+        m_clock.start();
+    }
 
-    void setCategoryFilter(const QString &cat) { m_category = cat; invalidateFilter(); }
-    void setSearchFilter(const QString &search) { m_search = search.toLower(); invalidateFilter(); }
-    QString categoryFilter() const { return m_category; }
+    // timeoutMs is an inactivity timeout: a download that keeps making
+    // progress is never cut off, one that stalls is aborted.
+    static QNetworkRequest request(const QUrl &url, int timeoutMs = 0) {
+        QNetworkRequest req(url);
+        req.setRawHeader("User-Agent", "LiveTVPlayer/2.0");
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+        req.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                         QNetworkRequest::NoLessSafeRedirectPolicy);
+#else
+        req.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+#endif
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+        req.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+        if (timeoutMs > 0) req.setTransferTimeout(timeoutMs);
+#else
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+        req.setAttribute(QNetworkRequest::HTTP2AllowedAttribute, true);
+#endif
+        req.setAttribute(QNetworkRequest::User, timeoutMs);
+#endif
+        return req;
+    }
 
-protected:
-    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override {
-        QModelIndex idx = sourceModel()->index(sourceRow, 0, sourceParent);
-        if (!idx.isValid()) return false;
-        if (!m_category.isEmpty() && m_category != "All") {
-            if (idx.data(CategoryRole).toString() != m_category) return false;
-        }
-        if (!m_search.isEmpty()) {
-            if (!idx.data(NameRole).toString().toLower().contains(m_search)) return false;
-        }
-        return true;
+    QNetworkReply *get(const QNetworkRequest &req) { return track(m_nam->get(req)); }
+    QNetworkReply *head(const QNetworkRequest &req) { return track(m_nam->head(req)); }
+
+    // HTTP/1.1 is capped at six connections per host inside Qt, so asking
+    // for more only queues; once a host has answered over HTTP/2 its
+    // requests are multiplexed on one connection and can run much wider.
+    int hostLimit(const QString &host) const {
+        return m_http2Hosts.contains(host) ? NET_HTTP2_HOST_LIMIT : NET_HTTP1_HOST_LIMIT;
     }
 
+    bool isHttp2(const QString &host) const { return m_http2Hosts.contains(host); }
+
+signals:
+    // A download finished cleanly; ms runs from the request being issued.
+    void transferred(qint64 bytes, qint64 ms);
+
 private:
-    QString m_category;
-    QString m_search;
+    QNetworkReply *track(QNetworkReply *reply) {
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+        int timeoutMs = reply->request().attribute(QNetworkRequest::User).toInt();
+        if (timeoutMs > 0) {
+            QTimer::singleShot(timeoutMs, reply, [reply]() {
+                if (reply->isRunning()) reply->abort();
+            });
+        }
+#endif
+        connect(reply, &QNetworkReply::metaDataChanged, this, [this, reply]() {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+            bool http2 = reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool();
+#elif QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+            bool http2 = reply->attribute(QNetworkRequest::HTTP2WasUsedAttribute).toBool();
+#else
+            bool http2 = false;
+#endif
+            if (http2) m_http2Hosts.insert(reply->url().host());
+        });
+        qint64 startedAt = m_clock.elapsed();
+        connect(reply, &QNetworkReply::downloadProgress, reply, [reply](qint64 received, qint64) {
+            reply->setProperty("bytesReceived", received);
+        });
+        connect(reply, &QNetworkReply::finished, this, [this, reply, startedAt]() {
+            if (reply->error() != QNetworkReply::NoError) return;
+            emit transferred(reply->property("bytesReceived").toLongLong(), m_clock.elapsed() - startedAt);
+        });
+        return reply;
+    }
+
+    QNetworkAccessManager *m_nam;
+    QSet<QString> m_http2Hosts;
+    QElapsedTimer m_clock;
 };
 
-class ChannelDelegate : public QStyledItemDelegate {
+class StreamProber : public QObject {
     Q_OBJECT
 public:
-    explicit ChannelDelegate(QObject *parent = nullptr) : QStyledItemDelegate(parent) {}
-    void setLogoCache(QHash<QString, QPixmap> *cache) { m_logoCache = cache; }
+    enum Liveness { Unknown, Alive, Dead };
+
+    explicit StreamProber(NetworkLayer *net, QObject *parent = nullptr)
+        : QObject(parent), m_net(net) {
+        m_clock.start();
+        m_pumpTimer = new QTimer(this);
+        m_pumpTimer->setInterval(PROBE_PUMP_INTERVAL_MS);
+        connect(m_pumpTimer, &QTimer::timeout, this, &StreamProber::pump);
+    }
 
-    QSize sizeHint(const QStyleOptionViewItem &, const QModelIndex &) const override {
-        return QSize(172, 100);
+    void setUrls(const QStringList &urls) {
+        m_queue.clear();
+        m_queued.clear();
+        enqueue(urls, false);
     }
 
-    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override {
-        painter->save();
-        painter->setRenderHint(QPainter::Antialiasing, true);
+    void prioritize(const QStringList &urls) { enqueue(urls, true); }
 
-        QRect r = option.rect.adjusted(3, 3, -3, -3);
-        QPainterPath path;
-        path.addRoundedRect(QRectF(r), 10, 10);
+    // Queued probes wait; probes already in flight complete.
+    void setPaused(bool paused) {
+        m_paused = paused;
+        if (paused) m_pumpTimer->stop();
+        else if (!m_queue.isEmpty()) m_pumpTimer->start();
+    }
 
-        QColor cardBg(38, 40, 58);
-        if (option.state & QStyle::State_Selected) {
-            cardBg = QColor(59, 130, 246);
-        } else if (option.state & QStyle::State_MouseOver) {
-            cardBg = QColor(50, 54, 78);
-        }
+    Liveness liveness(const QString &url) const {
+        QHash<QString, Entry>::const_iterator it = m_cache.constFind(url);
+        return it == m_cache.constEnd() ? Unknown : it->state;
+    }
 
-        painter->fillPath(path, cardBg);
-        painter->setPen(QPen(QColor(255, 255, 255, 15), 1));
-        painter->drawPath(path);
+signals:
+    void probed(const QString &url, int liveness);
+    void livenessChanged(const QString &url, int previous, int liveness);
 
-        QRect iconRect(r.left() + 10, r.top() + 8, 52, 42);
-        QString logoUrl = index.data(LogoUrlRole).toString();
-        QString name = index.data(NameRole).toString();
-        if (name.length() > MAX_NAME_LEN) name = name.left(MAX_NAME_LEN) + "...";
-        QString category = index.data(CategoryRole).toString();
+private:
+    struct Entry {
+        Liveness state = Unknown;
+        qint64 checkedAt = 0;
+    };
+
+    bool isFresh(const QString &url) const {
+        QHash<QString, Entry>::const_iterator it = m_cache.constFind(url);
+        if (it == m_cache.constEnd() || it->state == Unknown) return false;
+        qint64 ttl = it->state == Alive ? PROBE_ALIVE_TTL_MS : PROBE_DEAD_TTL_MS;
+        return m_clock.elapsed() - it->checkedAt < ttl;
+    }
 
-        bool drawn = false;
-        if (m_logoCache && !logoUrl.isEmpty() && m_logoCache->contains(logoUrl)) {
-            QPixmap pm = m_logoCache->value(logoUrl);
-            if (!pm.isNull()) {
-                QPainterPath clipPath;
-                clipPath.addRoundedRect(QRectF(iconRect), 6, 6);
-                painter->setClipPath(clipPath);
-                QPixmap scaled = pm.scaled(iconRect.size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                int dx = iconRect.left() + (iconRect.width() - scaled.width()) / 2;
-                int dy = iconRect.top() + (iconRect.height() - scaled.height()) / 2;
-                painter->drawPixmap(dx, dy, scaled);
-                painter->setClipping(false);
-                drawn = true;
+    void enqueue(const QStringList &urls, bool front) {
+        QStringList fresh;
+        for (int i = 0; i < urls.size(); ++i) {
+            const QString &u = urls[i];
+            if (u.isEmpty() || m_inFlight.contains(u) || isFresh(u)) continue;
+            if (m_queued.contains(u)) {
+                if (!front) continue;
+                m_queue.removeOne(u);
             }
+            fresh.append(u);
+            m_queued.insert(u);
         }
+        m_queue = front ? fresh + m_queue : m_queue + fresh;
+        if (!m_paused && !m_queue.isEmpty() && !m_pumpTimer->isActive()) m_pumpTimer->start();
+    }
 
-        if (!drawn) {
-            QPainterPath clipPath;
-            clipPath.addRoundedRect(QRectF(iconRect), 6, 6);
-            int h = name.isEmpty() ? 200 : qAbs(name.at(0).unicode() * 47) % 360;
-            QLinearGradient grad(iconRect.topLeft(), iconRect.bottomRight());
-            grad.setColorAt(0, QColor::fromHsv(h, 140, 120));
-            grad.setColorAt(1, QColor::fromHsv((h + 40) % 360, 120, 90));
-            painter->fillPath(clipPath, grad);
-            painter->setPen(QColor(255, 255, 255, 220));
-            QFont f = painter->font();
-            f.setPixelSize(20);
-            f.setBold(true);
-            painter->setFont(f);
-            painter->drawText(iconRect, Qt::AlignCenter, name.isEmpty() ? "?" : name.left(1).toUpper());
+    void pump() {
+        // One probe per tick keeps the sweep in the background even when the
+        // queue holds the whole playlist.
+        if (m_inFlight.size() >= MAX_CONCURRENT_PROBES) return;
+        while (!m_queue.isEmpty()) {
+            QString url = m_queue.takeFirst();
+            m_queued.remove(url);
+            if (isFresh(url)) continue;
+            probe(url);
+            break;
         }
+        if (m_queue.isEmpty()) m_pumpTimer->stop();
+    }
 
-        painter->setPen(QColor(240, 240, 245));
-        QFont nameFont = painter->font();
-        nameFont.setPixelSize(11);
-        nameFont.setBold(true);
-        nameFont.setFamily("Segoe UI");
-        painter->setFont(nameFont);
-        QRect nameRect(r.left() + 8, r.top() + 56, r.width() - 16, 18);
-        QString elidedName = painter->fontMetrics().elidedText(name, Qt::ElideRight, nameRect.width());
-        painter->drawText(nameRect, Qt::AlignLeft | Qt::AlignVCenter, elidedName);
-
-        if (!category.isEmpty()) {
-            painter->setPen(QColor(148, 163, 184));
-            QFont catFont = nameFont;
-            catFont.setPixelSize(9);
-            catFont.setBold(false);
-            painter->setFont(catFont);
-            QRect catRect(r.left() + 8, r.top() + 76, r.width() - 16, 14);
-            QString elidedCat = painter->fontMetrics().elidedText(category, Qt::ElideRight, catRect.width());
-            painter->drawText(catRect, Qt::AlignLeft | Qt::AlignVCenter, elidedCat);
+    void probe(const QString &urlStr) {
+        QUrl url(urlStr);
+        QString scheme = url.scheme().toLower();
+        m_inFlight.insert(urlStr);
+        if (scheme == "http" || scheme == "https") {
+            probeHttp(url, urlStr);
+        } else {
+            probeSocket(url, urlStr, scheme);
         }
+    }
 
-        painter->restore();
+    void probeHttp(const QUrl &url, const QString &urlStr) {
+        // A ranged GET is answered by servers that reject HEAD, and an
+        // endless MPEG-TS response is cut off after the first bytes.
+        QNetworkRequest req = NetworkLayer::request(url, PROBE_TIMEOUT_MS);
+        req.setRawHeader("Range", "bytes=0-2047");
+        req.setPriority(QNetworkRequest::LowPriority);
+
+        QNetworkReply *reply = m_net->get(req);
+        bool manifest = url.path().endsWith(".m3u8", Qt::CaseInsensitive);
+
+        connect(reply, &QNetworkReply::readyRead, this, [reply]() {
+            if (reply->bytesAvailable() < 16 || !reply->isRunning()) return;
+            reply->setProperty("probeHead", reply->read(64));
+            reply->abort();
+        });
+
+        connect(reply, &QNetworkReply::finished, this, [this, reply, urlStr, manifest]() {
+            int code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            QByteArray head = (reply->property("probeHead").toByteArray() + reply->readAll()).trimmed();
+            bool alive = code >= 200 && code < 300 && !head.isEmpty();
+            QByteArray type = reply->header(QNetworkRequest::ContentTypeHeader).toByteArray().toLower();
+            if (alive && (manifest || type.contains("mpegurl"))) {
+                alive = head.startsWith("#EXTM3U");
+            }
+            reply->deleteLater();
+            finish(urlStr, alive);
+        });
     }
 
-private:
-    QHash<QString, QPixmap> *m_logoCache = nullptr;
+    void probeSocket(const QUrl &url, const QString &urlStr, const QString &scheme) {
+        int defaultPort = 80;
+        if (scheme == "rtsp") defaultPort = 554;
+        else if (scheme == "rtmp") defaultPort = 1935;
+        else if (scheme == "mms") defaultPort = 1755;
+
+        QTcpSocket *sock = new QTcpSocket(this);
+        QTimer *timeout = new QTimer(sock);
+        timeout->setSingleShot(true);
+
+        auto done = [this, sock, timeout, urlStr](bool alive) {
+            timeout->stop();
+            sock->disconnect(this);
+            sock->abort();
+            sock->deleteLater();
+            finish(urlStr, alive);
+        };
+        connect(sock, &QTcpSocket::connected, this, [done]() { done(true); });
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+        connect(sock, &QAbstractSocket::errorOccurred, this, [done]() { done(false); });
+#else
+        connect(sock, static_cast<void (QAbstractSocket::*)(QAbstractSocket::SocketError)>(&QAbstractSocket::error),
+                this, [done]() { done(false); });
+#endif
+        connect(timeout, &QTimer::timeout, this, [done]() { done(false); });
+        timeout->start(PROBE_TIMEOUT_MS);
+        sock->connectToHost(url.host(), static_cast<quint16>(url.port(defaultPort)));
+    }
+
+    void finish(const QString &url, bool alive) {
+        if (!m_inFlight.remove(url)) return;
+        Entry &e = m_cache[url];
+        Liveness previous = e.state;
+        e.state = alive ? Alive : Dead;
+        e.checkedAt = m_clock.elapsed();
+        emit probed(url, e.state);
+        if (e.state != previous) emit livenessChanged(url, previous, e.state);
+        if (!m_paused && !m_queue.isEmpty() && !m_pumpTimer->isActive()) m_pumpTimer->start();
+    }
+
+    NetworkLayer *m_net;
+    QTimer *m_pumpTimer;
+    QElapsedTimer m_clock;
+    QHash<QString, Entry> m_cache;
+    QStringList m_queue;
+    QSet<QString> m_queued;
+    QSet<QString> m_inFlight;
+    bool m_paused = false;
 };
 
-class OsdWidget : public QWidget {
+// Schedules logo downloads per host, round-robin, so a host serving
+// thousands of logos cannot starve the others. Each host's concurrency is
+// adjusted AIMD-style: it grows by one request per window of fast
+// successes, up to what the host's protocol can use, and halves on errors
+// or slow responses. Transient failures are retried with backoff; URLs that
+// keep failing are remembered so later launches leave them alone for a while.
+class LogoDownloader : public QObject {
     Q_OBJECT
 public:
-    explicit OsdWidget(QWidget *parent = nullptr) : QWidget(parent) {
-        setAttribute(Qt::WA_TransparentForMouseEvents);
-        setAttribute(Qt::WA_NoSystemBackground);
-        setAutoFillBackground(false);
-        hide();
-        m_hideTimer = new QTimer(this);
-        m_hideTimer->setSingleShot(true);
-        connect(m_hideTimer, &QTimer::timeout, this, [this]() {
-            m_opacity = 0.0;
-            hide();
-        });
-        m_opacity = 1.0;
+    struct Failure {
+        int count = 0;
+        qint64 retryAfter = 0;
+    };
+
+    explicit LogoDownloader(NetworkLayer *net, QObject *parent = nullptr) : QObject(parent), m_net(net) {
+        m_clock.start();
     }
 
-    void showOsd(const QString &channelName, const QString &category, int index, int total) {
-        m_channelName = channelName;
-        m_category = category;
-        m_index = index;
-        m_total = total;
-        m_opacity = 1.0;
-        show();
-        raise();
-        update();
-        m_hideTimer->start(OSD_DISPLAY_MS);
+    void setUrls(const QStringList &urls) {
+        for (auto it = m_hostState.begin(); it != m_hostState.end(); ++it) it->queue.clear();
+        m_hosts.clear();
+        qint64 now = QDateTime::currentMSecsSinceEpoch();
+        for (int i = 0; i < urls.size(); ++i) {
+            auto failed = m_failures.constFind(urls[i]);
+            if (failed != m_failures.constEnd() && failed->retryAfter > now) continue;
+            enqueue(QUrl(urls[i]).host(), urls[i], false);
+        }
+        pump();
     }
 
-protected:
-    void paintEvent(QPaintEvent *) override {
-        QPainter p(this);
-        p.setRenderHint(QPainter::Antialiasing);
-        p.setOpacity(m_opacity);
+    // Fetches a logo again ahead of the bulk queue, e.g. after the atlas
+    // dropped it.
+    void refetch(const QString &url) {
+        enqueue(QUrl(url).host(), url, true);
+        pump();
+    }
 
-        int boxW = qMin(width() - 60, 520);
-        int boxH = 90;
-        int x = (width() - boxW) / 2;
-        int y = height() - boxH - 50;
+    const QHash<QString, Failure> &failures() const { return m_failures; }
 
-        QPainterPath bgPath;
-        bgPath.addRoundedRect(x, y, boxW, boxH, 16, 16);
-        p.fillPath(bgPath, QColor(15, 15, 30, 210));
-        p.setPen(QPen(QColor(255, 255, 255, 30), 1));
-        p.drawPath(bgPath);
+    void setFailures(const QHash<QString, Failure> &failures) { m_failures = failures; }
 
-        p.setPen(Qt::NoPen);
-        p.setBrush(QColor(99, 102, 241));
-        p.drawRoundedRect(x + 16, y + 14, 4, boxH - 28, 2, 2);
+    void setPaused(bool paused) {
+        m_paused = paused;
+        pump();
+    }
 
-        p.setPen(Qt::white);
-        QFont f = font();
-        f.setPixelSize(20);
-        f.setBold(true);
-        p.setFont(f);
-        QString elidedName = p.fontMetrics().elidedText(m_channelName, Qt::ElideRight, boxW - 50);
-        p.drawText(x + 30, y + 16, boxW - 50, 30, Qt::AlignLeft | Qt::AlignVCenter, elidedName);
+signals:
+    void downloaded(const QString &url, const QByteArray &data);
 
-        f.setPixelSize(13);
-        f.setBold(false);
-        p.setFont(f);
-        p.setPen(QColor(165, 180, 210));
-        QString info = m_category;
-        if (m_total > 0) info += QString("  |  %1 of %2").arg(m_index + 1).arg(m_total);
-        p.drawText(x + 30, y + 50, boxW - 50, 24, Qt::AlignLeft | Qt::AlignVCenter, info);
+private:
+    struct HostState {
+        QStringList queue;
+        int active = 0;
+        double limit = LOGO_INITIAL_HOST_LIMIT;
+        qint64 lastDecrease = -LOGO_SLOW_MS;
+    };
+
+    void enqueue(const QString &host, const QString &url, bool front) {
+        HostState &h = m_hostState[host];
+        if (h.queue.isEmpty()) m_hosts.append(host);
+        if (front) h.queue.prepend(url);
+        else h.queue.append(url);
+    }
+
+    int hostLimit(const QString &host, const HostState &h) const {
+        return qMin(static_cast<int>(h.limit), m_net->hostLimit(host));
+    }
+
+    void pump() {
+        if (m_paused) return;
+        bool started = true;
+        while (started && m_inFlight < LOGO_MAX_IN_FLIGHT) {
+            started = false;
+            for (int i = 0; i < m_hosts.size() && m_inFlight < LOGO_MAX_IN_FLIGHT;) {
+                HostState &h = m_hostState[m_hosts[i]];
+                if (h.queue.isEmpty()) {
+                    m_hosts.removeAt(i);
+                    continue;
+                }
+                if (h.active < hostLimit(m_hosts[i], h)) {
+                    download(m_hosts[i], h.queue.takeFirst());
+                    started = true;
+                }
+                ++i;
+            }
+        }
+    }
+
+    void download(const QString &host, const QString &url) {
+        QNetworkReply *reply = m_net->get(NetworkLayer::request(QUrl(url), IMAGE_TIMEOUT_MS));
+        m_hostState[host].active++;
+        m_inFlight++;
+        qint64 startedAt = m_clock.elapsed();
+        connect(reply, &QNetworkReply::finished, this, [this, reply, host, url, startedAt]() {
+            ProfileScope scope("LogoDownloader::finished");
+            HostState &h = m_hostState[host];
+            h.active--;
+            m_inFlight--;
+            qint64 elapsed = m_clock.elapsed() - startedAt;
+            QNetworkReply::NetworkError error = reply->error();
+            int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            QByteArray data = error == QNetworkReply::NoError ? reply->readAll() : QByteArray();
+            reply->deleteLater();
+
+            if (error == QNetworkReply::NoError) {
+                if (elapsed > LOGO_SLOW_MS) backOff(h);
+                else h.limit = qMin<double>(m_net->hostLimit(host), h.limit + 1.0 / h.limit);
+                m_attempts.remove(url);
+                m_failures.remove(url);
+                if (!data.isEmpty() && data.size() < 2 * 1024 * 1024) emit downloaded(url, data);
+            } else if (error == QNetworkReply::HostNotFoundError) {
+                // The whole host is gone; everything still queued for it
+                // would fail the same way.
+                markFailed(url);
+                for (const QString &queued : h.queue) markFailed(queued);
+                h.queue.clear();
+            } else {
+                bool transient = status == 0 ? error != QNetworkReply::ProtocolUnknownError
+                                             : status >= 500 || status == 408 || status == 429;
+                if (transient) backOff(h);
+                int attempt = ++m_attempts[url];
+                if (transient && attempt <= LOGO_MAX_RETRIES) {
+                    QTimer::singleShot(LOGO_RETRY_BASE_MS << (attempt - 1), this, [this, host, url]() {
+                        enqueue(host, url, true);
+                        pump();
+                    });
+                } else {
+                    m_attempts.remove(url);
+                    markFailed(url);
+                }
+            }
+            pump();
+        });
+    }
+
+    // Responses that fail or arrive together as one burst only count as a
+    // single congestion signal.
+    void backOff(HostState &h) {
+        qint64 now = m_clock.elapsed();
+        if (now - h.lastDecrease < LOGO_SLOW_MS) return;
+        h.lastDecrease = now;
+        h.limit = qMax(1.0, h.limit / 2);
+    }
+
+    void markFailed(const QString &url) {
+        Failure &f = m_failures[url];
+        f.count++;
+        qint64 wait = qMin(LOGO_FAILURE_MAX_TTL_MS, LOGO_FAILURE_TTL_MS << qMin(f.count - 1, 8));
+        f.retryAfter = QDateTime::currentMSecsSinceEpoch() + wait;
+    }
+
+    NetworkLayer *m_net;
+    QElapsedTimer m_clock;
+    QHash<QString, HostState> m_hostState;
+    QStringList m_hosts;
+    QHash<QString, int> m_attempts;
+    QHash<QString, Failure> m_failures;
+    int m_inFlight = 0;
+    bool m_paused = false;
+};
+
+// Filters by category, search text and liveness, and orders rows by a rank
+// per source row. Ranks are computed up front from precomputed keys (name
+// collation keys are built once per playlist load), so lessThan is a plain
+// integer comparison and switching modes never touches the strings again.
+class CategoryFilterProxy : public QSortFilterProxyModel {
+    Q_OBJECT
+public:
+    enum SortMode { PlaylistOrder, SortByName, SortByNumber, MostWatched, RecentlyWatched };
+
+    explicit CategoryFilterProxy(QObject *parent = nullptr) : QSortFilterProxyModel(parent) {}
+
+    // Ranks belong to one set of source rows; a reset makes them stale until
+    // rebuildSortKeys() runs, so they are dropped before the proxy re-sorts.
+    void setSourceModel(QAbstractItemModel *model) override {
+        if (sourceModel()) disconnect(sourceModel(), &QAbstractItemModel::modelAboutToBeReset, this, nullptr);
+        QSortFilterProxyModel::setSourceModel(model);
+        if (!model) return;
+        connect(model, &QAbstractItemModel::modelAboutToBeReset, this, [this]() {
+            m_rank.clear();
+            m_nameRank.clear();
+        });
+    }
+
+    void setCategoryFilter(const QString &cat) {
+        m_category = cat;
+        m_filterByUrl = false;
+        m_urlFilter.clear();
+        refilter();
+    }
+
+    // For categories that come from history rather than the playlist.
+    void setUrlFilter(const QString &name, const QSet<QString> &urls) {
+        m_category = name;
+        m_filterByUrl = true;
+        m_urlFilter = urls;
+        refilter();
+    }
+
+    void setSearchFilter(const QString &search) { m_search = search.toLower(); refilter(); }
+    void setProber(const StreamProber *prober) {
+        m_prober = prober;
+        connect(prober, &StreamProber::livenessChanged, this, [this](const QString &, int previous, int liveness) {
+            if ((previous == StreamProber::Dead) != (liveness == StreamProber::Dead)) m_deadSetChanged = true;
+        });
+    }
+    void setHideDead(bool hide) { m_hideDead = hide; m_deadSetChanged = false; refilter(); }
+    // Probe results that did not move a channel into or out of Dead leave
+    // the filtered rows as they are, so a sweep does not refilter every tick.
+    void refreshLiveness() {
+        if (m_hideDead && m_deadSetChanged) refilter();
+        m_deadSetChanged = false;
+    }
+    void setWatchStats(const QHash<QString, WatchStat> *stats) { m_watchStats = stats; }
+    QString categoryFilter() const { return m_category; }
+    bool hideDead() const { return m_hideDead; }
+    SortMode sortMode() const { return m_sortMode; }
+
+    void setSortMode(SortMode mode) {
+        m_sortMode = mode;
+        resort();
+    }
+
+    // Must be called after the source model's channels are replaced.
+    void rebuildSortKeys() {
+        const ChannelModel *model = qobject_cast<const ChannelModel *>(sourceModel());
+        if (!model) return;
+        const QVector<Channel> &chans = model->channels();
+        QCollator collator;
+        collator.setNumericMode(true);
+        collator.setCaseSensitivity(Qt::CaseInsensitive);
+        std::vector<QCollatorSortKey> keys;
+        keys.reserve(chans.size());
+        for (int i = 0; i < chans.size(); ++i) keys.push_back(collator.sortKey(chans[i].name));
+
+        QVector<int> order = identityOrder(chans.size());
+        std::sort(order.begin(), order.end(), [&keys](int a, int b) {
+            int c = keys[a].compare(keys[b]);
+            return c != 0 ? c < 0 : a < b;
+        });
+        m_nameRank = ranksFromOrder(order);
+        resort();
+    }
+
+protected:
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override {
+        int a = left.row();
+        int b = right.row();
+        if (a < m_rank.size() && b < m_rank.size()) return m_rank[a] < m_rank[b];
+        return a < b;
+    }
+
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override {
+        QModelIndex idx = sourceModel()->index(sourceRow, 0, sourceParent);
+        if (!idx.isValid()) return false;
+        if (m_filterByUrl) {
+            if (!m_urlFilter.contains(idx.data(StreamUrlRole).toString())) return false;
+        } else if (!m_category.isEmpty()) {
+            if (idx.data(CategoryRole).toString() != m_category) return false;
+        }
+        if (!m_search.isEmpty()) {
+            if (!idx.data(NameRole).toString().toLower().contains(m_search)) return false;
+        }
+        if (m_hideDead && m_prober) {
+            if (m_prober->liveness(idx.data(StreamUrlRole).toString()) == StreamProber::Dead) return false;
+        }
+        return true;
     }
 
 private:
-    QTimer *m_hideTimer;
-    QString m_channelName;
+    void refilter() {
+        ProfileScope scope("CategoryFilterProxy::filter");
+        invalidateFilter();
+    }
+
+    static QVector<int> identityOrder(int n) {
+        QVector<int> order(n);
+        for (int i = 0; i < n; ++i) order[i] = i;
+        return order;
+    }
+
+    static QVector<int> ranksFromOrder(const QVector<int> &order) {
+        QVector<int> rank(order.size());
+        for (int i = 0; i < order.size(); ++i) rank[order[i]] = i;
+        return rank;
+    }
+
+    void resort() {
+        ProfileScope scope("CategoryFilterProxy::sort");
+        const ChannelModel *model = qobject_cast<const ChannelModel *>(sourceModel());
+        if (m_sortMode == PlaylistOrder || !model || m_nameRank.size() != model->rowCount()) {
+            m_rank.clear();
+            sort(-1);
+            return;
+        }
+        const QVector<Channel> &chans = model->channels();
+        const QVector<int> &byName = m_nameRank;
+        QVector<int> order = identityOrder(chans.size());
+        switch (m_sortMode) {
+            case SortByNumber:
+                // Channels without a number follow the numbered ones, by name.
+                std::sort(order.begin(), order.end(), [&chans, &byName](int a, int b) {
+                    int na = chans[a].number > 0 ? chans[a].number : INT_MAX;
+                    int nb = chans[b].number > 0 ? chans[b].number : INT_MAX;
+                    return na != nb ? na < nb : byName[a] < byName[b];
+                });
+                m_rank = ranksFromOrder(order);
+                break;
+            case MostWatched:
+            case RecentlyWatched: {
+                // Most watched is by time actually spent on the stream; plays
+                // only break ties between channels that never got to play.
+                QVector<qint64> key(chans.size(), 0);
+                QVector<qint64> tie(chans.size(), 0);
+                if (m_watchStats) {
+                    for (int i = 0; i < chans.size(); ++i) {
+                        QHash<QString, WatchStat>::const_iterator it = m_watchStats->constFind(chans[i].streamUrl);
+                        if (it == m_watchStats->constEnd()) continue;
+                        key[i] = m_sortMode == MostWatched ? it->watchMs : it->lastWatched;
+                        if (m_sortMode == MostWatched) tie[i] = it->plays;
+                    }
+                }
+                std::sort(order.begin(), order.end(), [&key, &tie, &byName](int a, int b) {
+                    if (key[a] != key[b]) return key[a] > key[b];
+                    return tie[a] != tie[b] ? tie[a] > tie[b] : byName[a] < byName[b];
+                });
+                m_rank = ranksFromOrder(order);
+                break;
+            }
+            default:
+                m_rank = m_nameRank;
+                break;
+        }
+        // sort() returns early when column and order are unchanged, which
+        // they are between any two ranked modes.
+        if (sortColumn() == 0) invalidate();
+        else sort(0, Qt::AscendingOrder);
+    }
+
     QString m_category;
-    int m_index = 0;
-    int m_total = 0;
-    qreal m_opacity = 1.0;
+    bool m_filterByUrl = false;
+    QSet<QString> m_urlFilter;
+    QString m_search;
+    const StreamProber *m_prober = nullptr;
+    const QHash<QString, WatchStat> *m_watchStats = nullptr;
+    bool m_hideDead = false;
+    bool m_deadSetChanged = false;
+    SortMode m_sortMode = PlaylistOrder;
+    QVector<int> m_nameRank;
+    QVector<int> m_rank;
 };
 
-class VideoWidget : public QWidget {
+// Packs every scaled channel logo into a few large pages with a shelf
+// packer: logos are placed left to right along a shelf as tall as the
+// tallest logo on it, and a new shelf (or page) is opened when one fills.
+// The cache holds only page coordinates per URL, and the whole atlas is
+// written to one file so a warm start is a single read.
+class LogoAtlas {
+public:
+    explicit LogoAtlas(qreal dpr) : m_dpr(qMax<qreal>(1.0, dpr)) {}
+
+    bool contains(const QString &url) const { return m_slots.contains(url); }
+
+    void insert(const QString &url, const QImage &image) {
+        if (image.isNull() || m_slots.contains(url)) return;
+        QSize cell = (QSizeF(LOGO_WIDTH, LOGO_HEIGHT) * m_dpr).toSize();
+        QImage scaled = image.scaled(cell, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        if (scaled.isNull()) return;
+
+        if (m_page < 0 || m_shelfX + scaled.width() > LOGO_ATLAS_PAGE_SIZE) {
+            m_shelfY += m_shelfHeight;
+            m_shelfX = 0;
+            m_shelfHeight = 0;
+        }
+        if (m_page < 0 || m_shelfY + scaled.height() > LOGO_ATLAS_PAGE_SIZE) {
+            if (m_pages.size() < LOGO_ATLAS_MAX_PAGES) {
+                QPixmap page(LOGO_ATLAS_PAGE_SIZE, LOGO_ATLAS_PAGE_SIZE);
+                page.fill(Qt::transparent);
+                m_pages.append(page);
+                m_pageUse.append(0);
+                m_page = m_pages.size() - 1;
+            } else {
+                m_page = evictLeastRecentPage();
+            }
+            m_shelfX = 0;
+            m_shelfY = 0;
+            m_shelfHeight = 0;
+        }
+
+        Slot slot;
+        slot.page = m_page;
+        slot.rect = QRect(QPoint(m_shelfX, m_shelfY), scaled.size());
+        QPainter p(&m_pages[m_page]);
+        p.setCompositionMode(QPainter::CompositionMode_Source);
+        p.drawImage(slot.rect.topLeft(), scaled);
+        p.end();
+
+        m_shelfX += scaled.width() + 1;
+        m_shelfHeight = qMax(m_shelfHeight, scaled.height() + 1);
+        m_slots.insert(url, slot);
+        m_evicted.remove(url);
+        m_pageUse[m_page] = ++m_useTick;
+        m_dirty = true;
+    }
+
+    // Logos whose page was recycled. The view asks for them again when they
+    // come back on screen rather than all at once, which would only push out
+    // the pages that are visible now.
+    bool wasEvicted(const QString &url) const { return m_evicted.contains(url); }
+    bool forgetEvicted(const QString &url) { return m_evicted.remove(url); }
+
+    // Draws the logo centred in target at its natural aspect ratio.
+    bool draw(QPainter *painter, const QRect &target, const QString &url) const {
+        QHash<QString, Slot>::const_iterator it = m_slots.constFind(url);
+        if (it == m_slots.constEnd()) return false;
+        QSizeF size = QSizeF(it->rect.size()) / m_dpr;
+        QRectF dst(target.left() + (target.width() - size.width()) / 2,
+                   target.top() + (target.height() - size.height()) / 2, size.width(), size.height());
+        painter->drawPixmap(dst, m_pages[it->page], QRectF(it->rect));
+        m_pageUse[it->page] = ++m_useTick;
+        return true;
+    }
+
+    void clear() {
+        m_pages.clear();
+        m_pageUse.clear();
+        m_slots.clear();
+        m_evicted.clear();
+        m_page = -1;
+        m_shelfX = m_shelfY = m_shelfHeight = 0;
+        m_dirty = true;
+    }
+
+    bool load(const QString &path) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) return false;
+        QDataStream in(&file);
+        quint32 magic = 0;
+        qint32 version = 0;
+        double dpr = 0;
+        in >> magic >> version >> dpr;
+        if (magic != LOGO_ATLAS_MAGIC || version != 2 || !qFuzzyCompare(dpr, double(m_dpr))) return false;
+
+        qint32 currentPage, shelfX, shelfY, shelfHeight, pageCount;
+        in >> currentPage >> shelfX >> shelfY >> shelfHeight >> pageCount;
+        QVector<QPixmap> pages;
+        for (int i = 0; i < pageCount && in.status() == QDataStream::Ok; ++i) {
+            QImage image;
+            in >> image;
+            pages.append(QPixmap::fromImage(image));
+        }
+        qint32 slotCount;
+        in >> slotCount;
+        QHash<QString, Slot> slots;
+        slots.reserve(slotCount);
+        for (int i = 0; i < slotCount && in.status() == QDataStream::Ok; ++i) {
+            QString url;
+            Slot slot;
+            qint32 page;
+            in >> url >> page >> slot.rect;
+            slot.page = page;
+            if (page >= 0 && page < pages.size()) slots.insert(url, slot);
+        }
+        QStringList evicted;
+        in >> evicted;
+        if (in.status() != QDataStream::Ok || currentPage >= pages.size()) return false;
+
+        m_pages = pages;
+        m_pageUse = QVector<qint64>(pages.size(), 0);
+        m_slots = slots;
+        m_evicted.clear();
+        for (const QString &url : evicted) m_evicted.insert(url);
+        m_page = pages.isEmpty() ? -1 : currentPage;
+        m_shelfX = shelfX;
+        m_shelfY = shelfY;
+        m_shelfHeight = shelfHeight;
+        m_dirty = false;
+        return true;
+    }
+
+    bool save(const QString &path) {
+        if (!m_dirty) return true;
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+        QDataStream out(&file);
+        out << LOGO_ATLAS_MAGIC << qint32(2) << double(m_dpr);
+        out << qint32(m_page) << qint32(m_shelfX) << qint32(m_shelfY) << qint32(m_shelfHeight) << qint32(m_pages.size());
+        for (int i = 0; i < m_pages.size(); ++i) out << m_pages[i].toImage();
+        out << qint32(m_slots.size());
+        for (QHash<QString, Slot>::const_iterator it = m_slots.constBegin(); it != m_slots.constEnd(); ++it) {
+            out << it.key() << qint32(it->page) << it->rect;
+        }
+        out << QStringList(m_evicted.values());
+        m_dirty = false;
+        return out.status() == QDataStream::Ok;
+    }
+
+private:
+    struct Slot {
+        int page = 0;
+        QRect rect;
+    };
+
+    // Wipes the page drawn from longest ago and returns it for refilling.
+    int evictLeastRecentPage() {
+        int oldest = 0;
+        for (int i = 1; i < m_pageUse.size(); ++i) {
+            if (m_pageUse[i] < m_pageUse[oldest]) oldest = i;
+        }
+        for (QHash<QString, Slot>::iterator it = m_slots.begin(); it != m_slots.end();) {
+            if (it->page == oldest) {
+                m_evicted.insert(it.key());
+                it = m_slots.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        m_pages[oldest].fill(Qt::transparent);
+        return oldest;
+    }
+
+    qreal m_dpr;
+    QVector<QPixmap> m_pages;
+    mutable QVector<qint64> m_pageUse;
+    mutable qint64 m_useTick = 0;
+    QHash<QString, Slot> m_slots;
+    QSet<QString> m_evicted;
+    int m_page = -1;
+    int m_shelfX = 0;
+    int m_shelfY = 0;
+    int m_shelfHeight = 0;
+    bool m_dirty = false;
+};
+
+class ChannelDelegate : public QStyledItemDelegate {
     Q_OBJECT
 public:
-    explicit VideoWidget(QWidget *parent = nullptr) : QWidget(parent) {
-        setAttribute(Qt::WA_DontCreateNativeAncestors);
-        setAttribute(Qt::WA_NativeWindow);
-        setMinimumSize(320, 240);
-        setStyleSheet("background-color: #000;");
-        setFocusPolicy(Qt::NoFocus);
-        setMouseTracking(true);
+    explicit ChannelDelegate(QObject *parent = nullptr) : QStyledItemDelegate(parent) {}
+    void setLogoAtlas(const LogoAtlas *atlas) { m_logoAtlas = atlas; }
+    void setProber(const StreamProber *prober) { m_prober = prober; }
+    void setPreviews(const QHash<QString, QPixmap> *previews) { m_previews = previews; }
+
+    QSize sizeHint(const QStyleOptionViewItem &, const QModelIndex &) const override {
+        return QSize(172, 100);
+    }
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override {
+        ProfileScope scope("ChannelDelegate::paint");
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing, true);
+
+        QRect r = option.rect.adjusted(3, 3, -3, -3);
+        QPainterPath path;
+        path.addRoundedRect(QRectF(r), 10, 10);
+
+        QColor cardBg(38, 40, 58);
+        if (option.state & QStyle::State_Selected) {
+            cardBg = QColor(59, 130, 246);
+        } else if (option.state & QStyle::State_MouseOver) {
+            cardBg = QColor(50, 54, 78);
+        }
+
+        painter->fillPath(path, cardBg);
+        painter->setPen(QPen(QColor(255, 255, 255, 15), 1));
+        painter->drawPath(path);
+
+        QRect iconRect(r.left() + 10, r.top() + 8, LOGO_WIDTH, LOGO_HEIGHT);
+        QString logoUrl = index.data(LogoUrlRole).toString();
+        QString name = index.data(NameRole).toString();
+        if (name.length() > MAX_NAME_LEN) name = name.left(MAX_NAME_LEN) + "...";
+        QString category = index.data(CategoryRole).toString();
+        QString streamUrl = index.data(StreamUrlRole).toString();
+
+        bool drawn = false;
+        if (m_logoAtlas && !logoUrl.isEmpty() && m_logoAtlas->contains(logoUrl)) {
+            QPainterPath clipPath;
+            clipPath.addRoundedRect(QRectF(iconRect), 6, 6);
+            painter->setClipPath(clipPath);
+            drawn = m_logoAtlas->draw(painter, iconRect, logoUrl);
+            painter->setClipping(false);
+        } else if (m_logoAtlas && !logoUrl.isEmpty() && m_logoAtlas->wasEvicted(logoUrl)) {
+            emit logoEvicted(logoUrl);
+        }
+
+        if (!drawn) {
+            QPainterPath clipPath;
+            clipPath.addRoundedRect(QRectF(iconRect), 6, 6);
+            int h = name.isEmpty() ? 200 : qAbs(name.at(0).unicode() * 47) % 360;
+            QLinearGradient grad(iconRect.topLeft(), iconRect.bottomRight());
+            grad.setColorAt(0, QColor::fromHsv(h, 140, 120));
+            grad.setColorAt(1, QColor::fromHsv((h + 40) % 360, 120, 90));
+            painter->fillPath(clipPath, grad);
+            painter->setPen(QColor(255, 255, 255, 220));
+            QFont f = painter->font();
+            f.setPixelSize(20);
+            f.setBold(true);
+            painter->setFont(f);
+            painter->drawText(iconRect, Qt::AlignCenter, name.isEmpty() ? "?" : name.left(1).toUpper());
+        }
+
+        if (m_previews) {
+            QHash<QString, QPixmap>::const_iterator it = m_previews->constFind(streamUrl);
+            if (it != m_previews->constEnd()) {
+                QRect previewRect(iconRect.right() + 9, iconRect.top(), PREVIEW_WIDTH, PREVIEW_HEIGHT);
+                QPainterPath clipPath;
+                clipPath.addRoundedRect(QRectF(previewRect), 6, 6);
+                painter->setClipPath(clipPath);
+                painter->drawPixmap(previewRect, *it);
+                painter->setClipping(false);
+            }
+        }
+
+        painter->setPen(QColor(240, 240, 245));
+        QFont nameFont = painter->font();
+        nameFont.setPixelSize(11);
+        nameFont.setBold(true);
+        nameFont.setFamily("Segoe UI");
+        painter->setFont(nameFont);
+        QRect nameRect(r.left() + 8, r.top() + 56, r.width() - 16, 18);
+        QString elidedName = painter->fontMetrics().elidedText(name, Qt::ElideRight, nameRect.width());
+        painter->drawText(nameRect, Qt::AlignLeft | Qt::AlignVCenter, elidedName);
+
+        if (!category.isEmpty()) {
+            painter->setPen(QColor(148, 163, 184));
+            QFont catFont = nameFont;
+            catFont.setPixelSize(9);
+            catFont.setBold(false);
+            painter->setFont(catFont);
+            QRect catRect(r.left() + 8, r.top() + 76, r.width() - 16, 14);
+            QString elidedCat = painter->fontMetrics().elidedText(category, Qt::ElideRight, catRect.width());
+            painter->drawText(catRect, Qt::AlignLeft | Qt::AlignVCenter, elidedCat);
+        }
+
+        if (m_prober) {
+            StreamProber::Liveness live = m_prober->liveness(streamUrl);
+            if (live != StreamProber::Unknown) {
+                painter->setPen(Qt::NoPen);
+                painter->setBrush(live == StreamProber::Alive ? QColor(34, 197, 94) : QColor(239, 68, 68));
+                painter->drawEllipse(QPoint(r.right() - 10, r.top() + 10), 4, 4);
+            }
+        }
+
+        painter->restore();
     }
 
 signals:
-    void doubleClicked();
+    void logoEvicted(const QString &url) const;
+
+private:
+    const LogoAtlas *m_logoAtlas = nullptr;
+    const StreamProber *m_prober = nullptr;
+    const QHash<QString, QPixmap> *m_previews = nullptr;
+};
+
+// Grid view for uniformly sized channel cards. Every item rect is computed
+// arithmetically from the row number and the column count, so relayout on
+// resize or filtering is O(1) and painting and hit-testing only ever touch
+// the rows that are on screen.
+class ChannelGridView : public QAbstractItemView {
+    Q_OBJECT
+public:
+    explicit ChannelGridView(QWidget *parent = nullptr) : QAbstractItemView(parent) {
+        setSelectionMode(QAbstractItemView::SingleSelection);
+        setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+        viewport()->setMouseTracking(true);
+    }
+
+    void setSpacing(int spacing) {
+        m_spacing = spacing;
+        scheduleDelayedItemsLayout();
+    }
+
+    int spacing() const { return m_spacing; }
+
+    void setModel(QAbstractItemModel *model) override {
+        for (const QMetaObject::Connection &c : m_modelConnections) disconnect(c);
+        m_modelConnections.clear();
+        QAbstractItemView::setModel(model);
+        if (!model) return;
+        auto relayout = [this]() {
+            m_hoverRow = -1;
+            scheduleDelayedItemsLayout();
+        };
+        m_modelConnections << connect(model, &QAbstractItemModel::rowsInserted, this, relayout)
+                           << connect(model, &QAbstractItemModel::rowsRemoved, this, relayout)
+                           << connect(model, &QAbstractItemModel::modelReset, this, relayout)
+                           << connect(model, &QAbstractItemModel::layoutChanged, this, relayout);
+    }
+
+    // Rows [first, last) that intersect the viewport.
+    void visibleRange(int *first, int *last) const {
+        int rows = model() ? model()->rowCount(rootIndex()) : 0;
+        int top = verticalOffset() / cellHeight();
+        int bottom = (verticalOffset() + viewport()->height()) / cellHeight();
+        *first = qMin(rows, top * m_columns);
+        *last = qMin(rows, (bottom + 1) * m_columns);
+    }
+
+    QRect visualRect(const QModelIndex &index) const override {
+        if (!index.isValid() || index.parent() != rootIndex()) return QRect();
+        return itemRect(index.row()).translated(0, -verticalOffset());
+    }
+
+    void scrollTo(const QModelIndex &index, ScrollHint hint = EnsureVisible) override {
+        if (!index.isValid()) return;
+        QRect r = itemRect(index.row()).adjusted(0, -m_spacing, 0, m_spacing);
+        int top = verticalOffset();
+        int height = viewport()->height();
+        int value = top;
+        if (hint == PositionAtTop) value = r.top();
+        else if (hint == PositionAtBottom) value = r.bottom() - height + 1;
+        else if (hint == PositionAtCenter) value = r.center().y() - height / 2;
+        else if (r.top() < top) value = r.top();
+        else if (r.bottom() >= top + height) value = r.bottom() - height + 1;
+        verticalScrollBar()->setValue(value);
+    }
+
+    QModelIndex indexAt(const QPoint &point) const override {
+        if (!model()) return QModelIndex();
+        QPoint p = point + QPoint(0, verticalOffset());
+        if (p.x() < 0 || p.y() < 0) return QModelIndex();
+        int col = p.x() / cellWidth();
+        if (col >= m_columns) return QModelIndex();
+        int row = (p.y() / cellHeight()) * m_columns + col;
+        if (row >= model()->rowCount(rootIndex()) || !itemRect(row).contains(p)) return QModelIndex();
+        return model()->index(row, 0, rootIndex());
+    }
 
 protected:
-    void mouseDoubleClickEvent(QMouseEvent *event) override {
-        emit doubleClicked();
-        QWidget::mouseDoubleClickEvent(event);
+    QModelIndex moveCursor(CursorAction action, Qt::KeyboardModifiers) override {
+        int rows = model() ? model()->rowCount(rootIndex()) : 0;
+        if (rows == 0) return QModelIndex();
+        int current = currentIndex().isValid() ? currentIndex().row() : 0;
+        int page = qMax(1, viewport()->height() / cellHeight()) * m_columns;
+        int next = current;
+        switch (action) {
+            case MoveLeft:
+            case MovePrevious: next = current - 1; break;
+            case MoveRight:
+            case MoveNext: next = current + 1; break;
+            case MoveUp: next = current - m_columns; break;
+            case MoveDown: next = current + m_columns; break;
+            case MovePageUp: next = current - page; break;
+            case MovePageDown: next = current + page; break;
+            case MoveHome: next = 0; break;
+            case MoveEnd: next = rows - 1; break;
+        }
+        if (next < 0 || next >= rows) next = qBound(0, next, rows - 1);
+        return model()->index(next, 0, rootIndex());
+    }
+
+    int horizontalOffset() const override { return 0; }
+    int verticalOffset() const override { return verticalScrollBar()->value(); }
+    bool isIndexHidden(const QModelIndex &) const override { return false; }
+
+    void setSelection(const QRect &rect, QItemSelectionModel::SelectionFlags command) override {
+        QRect r = rect.normalized().translated(0, verticalOffset());
+        int rows = model() ? model()->rowCount(rootIndex()) : 0;
+        int firstLine = qMax(0, r.top() / cellHeight());
+        int lastLine = qMax(0, r.bottom() / cellHeight());
+        int firstCol = qBound(0, r.left() / cellWidth(), m_columns - 1);
+        int lastCol = qBound(0, r.right() / cellWidth(), m_columns - 1);
+        QItemSelection selection;
+        for (int line = firstLine; line <= lastLine; ++line) {
+            for (int col = firstCol; col <= lastCol; ++col) {
+                int row = line * m_columns + col;
+                if (row >= rows || !itemRect(row).intersects(r)) continue;
+                QModelIndex idx = model()->index(row, 0, rootIndex());
+                selection.select(idx, idx);
+            }
+        }
+        selectionModel()->select(selection, command);
+    }
+
+    QRegion visualRegionForSelection(const QItemSelection &selection) const override {
+        QRegion region;
+        const QModelIndexList indexes = selection.indexes();
+        for (const QModelIndex &idx : indexes) region += visualRect(idx);
+        return region;
+    }
+
+    void updateGeometries() override {
+        QStyleOptionViewItem option = itemOption();
+        m_itemSize = itemDelegate() ? itemDelegate()->sizeHint(option, QModelIndex()) : QSize(172, 100);
+        m_columns = qMax(1, viewport()->width() / cellWidth());
+        int rows = model() ? model()->rowCount(rootIndex()) : 0;
+        int lines = (rows + m_columns - 1) / m_columns;
+        int content = lines * cellHeight();
+        verticalScrollBar()->setSingleStep(cellHeight() / 4);
+        verticalScrollBar()->setPageStep(viewport()->height());
+        verticalScrollBar()->setRange(0, qMax(0, content - viewport()->height()));
+        QAbstractItemView::updateGeometries();
+    }
+
+    void paintEvent(QPaintEvent *event) override {
+        if (!model()) return;
+        ProfileScope scope("ChannelGridView::frame");
+        QPainter painter(viewport());
+        QStyleOptionViewItem option = itemOption();
+        QModelIndex current = currentIndex();
+        int rows = model()->rowCount(rootIndex());
+        QRect area = event->rect().translated(0, verticalOffset());
+        int firstLine = qMax(0, area.top() / cellHeight());
+        int lastLine = area.bottom() / cellHeight();
+        for (int line = firstLine; line <= lastLine; ++line) {
+            for (int col = 0; col < m_columns; ++col) {
+                int row = line * m_columns + col;
+                if (row >= rows) return;
+                QModelIndex idx = model()->index(row, 0, rootIndex());
+                option.rect = visualRect(idx);
+                option.state = QStyle::State_Enabled;
+                if (selectionModel() && selectionModel()->isSelected(idx)) option.state |= QStyle::State_Selected;
+                if (row == m_hoverRow) option.state |= QStyle::State_MouseOver;
+                if (idx == current && hasFocus()) option.state |= QStyle::State_HasFocus;
+                itemDelegate()->paint(&painter, option, idx);
+            }
+        }
+    }
+
+    void mouseMoveEvent(QMouseEvent *event) override {
+        QModelIndex idx = indexAt(event->pos());
+        setHoverRow(idx.isValid() ? idx.row() : -1);
+        QAbstractItemView::mouseMoveEvent(event);
+    }
+
+    bool viewportEvent(QEvent *event) override {
+        if (event->type() == QEvent::Leave) setHoverRow(-1);
+        return QAbstractItemView::viewportEvent(event);
+    }
+
+private:
+    int cellWidth() const { return m_itemSize.width() + 2 * m_spacing; }
+    int cellHeight() const { return m_itemSize.height() + 2 * m_spacing; }
+
+    // Content coordinates, before the scroll offset is applied.
+    QRect itemRect(int row) const {
+        return QRect((row % m_columns) * cellWidth() + m_spacing, (row / m_columns) * cellHeight() + m_spacing,
+                     m_itemSize.width(), m_itemSize.height());
+    }
+
+    QStyleOptionViewItem itemOption() const {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        QStyleOptionViewItem option;
+        initViewItemOption(&option);
+        return option;
+#else
+        return viewOptions();
+#endif
+    }
+
+    void setHoverRow(int row) {
+        if (row == m_hoverRow) return;
+        int previous = m_hoverRow;
+        m_hoverRow = row;
+        if (!model()) return;
+        if (previous >= 0 && previous < model()->rowCount(rootIndex())) {
+            viewport()->update(visualRect(model()->index(previous, 0, rootIndex())));
+        }
+        if (row >= 0) viewport()->update(visualRect(model()->index(row, 0, rootIndex())));
+    }
+
+    QSize m_itemSize = QSize(172, 100);
+    int m_spacing = 0;
+    int m_columns = 1;
+    int m_hoverRow = -1;
+    QVector<QMetaObject::Connection> m_modelConnections;
+};
+
+// Parses XMLTV off the GUI thread; a week of guide data for a large playlist
+// is tens of megabytes of XML.
+class EpgLoader : public QObject {
+    Q_OBJECT
+public slots:
+    // generation is handed back with the result so the caller can drop a
+    // guide that belongs to a playlist it has since replaced.
+    void parse(const QByteArray &data, int generation) {
+        ProfileScope scope("EpgLoader::parse");
+        QByteArray xml;
+        if (data.startsWith("\x1f\x8b")) {
+            if (!gunzip(data, EPG_MAX_DOWNLOAD_SIZE, &xml)) {
+                emit failed("Could not decompress the programme guide.", generation);
+                return;
+            }
+        } else {
+            xml = data;
+        }
+        EpgGuidePtr guide(parseXmltv(xml, QDateTime::currentMSecsSinceEpoch() - EPG_PAST_MS));
+        emit parsed(guide, generation);
+    }
+
+signals:
+    void parsed(EpgGuidePtr guide, int generation);
+    void failed(const QString &message, int generation);
+};
+
+// Programme guide: one row per channel of the current filter, time across.
+// It shares the grid's model and selection model. Painting visits only the
+// rows on screen and, per row, binary-searches the programme list for the
+// visible time span; titles are elided and laid out once into QStaticText.
+class EpgView : public QAbstractItemView {
+    Q_OBJECT
+public:
+    explicit EpgView(QWidget *parent = nullptr) : QAbstractItemView(parent) {
+        setSelectionMode(QAbstractItemView::SingleSelection);
+        setSelectionBehavior(QAbstractItemView::SelectRows);
+        QFont f = font();
+        f.setPixelSize(11);
+        setFont(f);
+        m_nowTimer = new QTimer(this);
+        m_nowTimer->setInterval(EPG_NOW_REFRESH_MS);
+        connect(m_nowTimer, &QTimer::timeout, viewport(), static_cast<void (QWidget::*)()>(&QWidget::update));
+        resetTimeline();
+    }
+
+    void setModel(QAbstractItemModel *model) override {
+        for (const QMetaObject::Connection &c : m_modelConnections) disconnect(c);
+        m_modelConnections.clear();
+        QAbstractItemView::setModel(model);
+        if (!model) return;
+        auto relayout = [this]() { scheduleDelayedItemsLayout(); };
+        m_modelConnections << connect(model, &QAbstractItemModel::rowsInserted, this, relayout)
+                           << connect(model, &QAbstractItemModel::rowsRemoved, this, relayout)
+                           << connect(model, &QAbstractItemModel::modelReset, this, relayout)
+                           << connect(model, &QAbstractItemModel::layoutChanged, this, relayout);
+    }
+
+    void setGuide(const EpgGuidePtr &guide) {
+        m_guide = guide;
+        m_titleCache.clear();
+        resetTimeline();
+        updateGeometries();
+        scrollToNow();
+        viewport()->update();
+    }
+
+    bool hasGuide() const { return m_guide && !m_guide->programmes.isEmpty(); }
+    EpgGuidePtr guide() const { return m_guide; }
+
+    void scrollToNow() {
+        horizontalScrollBar()->setValue(xForTime(QDateTime::currentMSecsSinceEpoch() - EPG_SLOT_MS));
+    }
+
+    QRect visualRect(const QModelIndex &index) const override {
+        if (!index.isValid() || index.parent() != rootIndex()) return QRect();
+        return QRect(0, EPG_HEADER_HEIGHT + index.row() * EPG_ROW_HEIGHT - verticalOffset(),
+                     viewport()->width(), EPG_ROW_HEIGHT);
+    }
+
+    void scrollTo(const QModelIndex &index, ScrollHint hint = EnsureVisible) override {
+        if (!index.isValid()) return;
+        int rowTop = index.row() * EPG_ROW_HEIGHT;
+        int top = verticalOffset();
+        int height = viewport()->height() - EPG_HEADER_HEIGHT;
+        int value = top;
+        if (hint == PositionAtTop) value = rowTop;
+        else if (hint == PositionAtBottom) value = rowTop + EPG_ROW_HEIGHT - height;
+        else if (hint == PositionAtCenter) value = rowTop + EPG_ROW_HEIGHT / 2 - height / 2;
+        else if (rowTop < top) value = rowTop;
+        else if (rowTop + EPG_ROW_HEIGHT > top + height) value = rowTop + EPG_ROW_HEIGHT - height;
+        verticalScrollBar()->setValue(value);
+    }
+
+    QModelIndex indexAt(const QPoint &point) const override {
+        if (!model() || point.y() < EPG_HEADER_HEIGHT) return QModelIndex();
+        int row = (point.y() - EPG_HEADER_HEIGHT + verticalOffset()) / EPG_ROW_HEIGHT;
+        if (row < 0 || row >= model()->rowCount(rootIndex())) return QModelIndex();
+        return model()->index(row, 0, rootIndex());
+    }
+
+protected:
+    QModelIndex moveCursor(CursorAction action, Qt::KeyboardModifiers) override {
+        int rows = model() ? model()->rowCount(rootIndex()) : 0;
+        if (rows == 0) return QModelIndex();
+        int current = currentIndex().isValid() ? currentIndex().row() : 0;
+        int page = qMax(1, (viewport()->height() - EPG_HEADER_HEIGHT) / EPG_ROW_HEIGHT);
+        int next = current;
+        switch (action) {
+            case MoveLeft:
+                horizontalScrollBar()->setValue(horizontalOffset() - xForTime(m_origin + EPG_SLOT_MS));
+                break;
+            case MoveRight:
+                horizontalScrollBar()->setValue(horizontalOffset() + xForTime(m_origin + EPG_SLOT_MS));
+                break;
+            case MovePrevious:
+            case MoveUp: next = current - 1; break;
+            case MoveNext:
+            case MoveDown: next = current + 1; break;
+            case MovePageUp: next = current - page; break;
+            case MovePageDown: next = current + page; break;
+            case MoveHome: next = 0; break;
+            case MoveEnd: next = rows - 1; break;
+        }
+        return model()->index(qBound(0, next, rows - 1), 0, rootIndex());
+    }
+
+    int horizontalOffset() const override { return horizontalScrollBar()->value(); }
+    int verticalOffset() const override { return verticalScrollBar()->value(); }
+    bool isIndexHidden(const QModelIndex &) const override { return false; }
+
+    void setSelection(const QRect &rect, QItemSelectionModel::SelectionFlags command) override {
+        if (!model()) return;
+        QRect r = rect.normalized();
+        QModelIndex first = indexAt(QPoint(0, qMax(r.top(), EPG_HEADER_HEIGHT)));
+        QModelIndex last = indexAt(QPoint(0, r.bottom()));
+        if (!first.isValid()) return;
+        if (!last.isValid()) last = model()->index(model()->rowCount(rootIndex()) - 1, 0, rootIndex());
+        selectionModel()->select(QItemSelection(first, last), command);
+    }
+
+    QRegion visualRegionForSelection(const QItemSelection &selection) const override {
+        QRegion region;
+        const QModelIndexList indexes = selection.indexes();
+        for (const QModelIndex &idx : indexes) region += visualRect(idx);
+        return region;
+    }
+
+    void updateGeometries() override {
+        int rows = model() ? model()->rowCount(rootIndex()) : 0;
+        int height = viewport()->height() - EPG_HEADER_HEIGHT;
+        int width = viewport()->width() - EPG_NAME_WIDTH;
+        verticalScrollBar()->setSingleStep(EPG_ROW_HEIGHT / 2);
+        verticalScrollBar()->setPageStep(height);
+        verticalScrollBar()->setRange(0, qMax(0, rows * EPG_ROW_HEIGHT - height));
+        horizontalScrollBar()->setSingleStep(EPG_PIXELS_PER_MINUTE * 5);
+        horizontalScrollBar()->setPageStep(width);
+        horizontalScrollBar()->setRange(0, qMax(0, xForTime(m_end) - width));
+        QAbstractItemView::updateGeometries();
+    }
+
+    void paintEvent(QPaintEvent *) override {
+        if (!model()) return;
+        ProfileScope scope("EpgView::frame");
+        QPainter p(viewport());
+        const int w = viewport()->width();
+        const int h = viewport()->height();
+        const QRect grid(EPG_NAME_WIDTH, EPG_HEADER_HEIGHT, w - EPG_NAME_WIDTH, h - EPG_HEADER_HEIGHT);
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        const qint64 t0 = timeForX(horizontalOffset());
+        const qint64 t1 = timeForX(horizontalOffset() + grid.width());
+        const int rows = model()->rowCount(rootIndex());
+        const int first = verticalOffset() / EPG_ROW_HEIGHT;
+        const int last = qMin(rows - 1, (verticalOffset() + grid.height()) / EPG_ROW_HEIGHT);
+        const QModelIndex current = currentIndex();
+
+        p.fillRect(viewport()->rect(), QColor(15, 15, 26));
+        for (int row = first; row <= last; ++row) {
+            QModelIndex idx = model()->index(row, 0, rootIndex());
+            int y = EPG_HEADER_HEIGHT + row * EPG_ROW_HEIGHT - verticalOffset();
+            bool selected = idx == current;
+            if (selected) p.fillRect(QRect(0, y, w, EPG_ROW_HEIGHT), QColor(59, 130, 246, 40));
+
+            const QVector<Programme> *list = programmesFor(idx);
+            if (list) {
+                // Programmes are sorted and do not overlap, so stop times are
+                // sorted too: the first one ending after t0 is the first visible.
+                auto it = std::upper_bound(list->constBegin(), list->constEnd(), t0,
+                                           [](qint64 t, const Programme &prog) { return t < prog.stop; });
+                for (; it != list->constEnd() && it->start < t1; ++it) {
+                    int x0 = EPG_NAME_WIDTH + xForTime(it->start) - horizontalOffset();
+                    int x1 = EPG_NAME_WIDTH + xForTime(it->stop) - horizontalOffset();
+                    QRect cell(x0 + 1, y + 2, x1 - x0 - 2, EPG_ROW_HEIGHT - 4);
+                    QRect clip = cell.intersected(grid);
+                    if (clip.isEmpty()) continue;
+                    bool airing = it->start <= now && now < it->stop;
+                    p.fillRect(clip, airing ? QColor(50, 54, 78) : QColor(30, 32, 48));
+                    if (cell.width() < 24) continue;
+                    // A title whose cell starts off screen sticks to the left edge.
+                    const QStaticText &text = titleText(&*it, cell.width() - 16);
+                    int textX = qMax(cell.left() + 8, grid.left() + 8);
+                    p.setClipRect(clip);
+                    p.setPen(airing ? QColor(240, 240, 245) : QColor(165, 180, 210));
+                    p.drawStaticText(textX, y + (EPG_ROW_HEIGHT - qRound(text.size().height())) / 2, text);
+                    p.setClipping(false);
+                }
+            }
+
+            p.fillRect(QRect(0, y, EPG_NAME_WIDTH, EPG_ROW_HEIGHT), selected ? QColor(59, 130, 246) : QColor(26, 26, 46));
+            const QStaticText &name = nameText(idx.data(NameRole).toString());
+            p.setPen(QColor(240, 240, 245));
+            p.drawStaticText(12, y + (EPG_ROW_HEIGHT - qRound(name.size().height())) / 2, name);
+        }
+
+        p.fillRect(QRect(0, 0, w, EPG_HEADER_HEIGHT), QColor(22, 22, 42));
+        p.setPen(QColor(148, 163, 184));
+        p.setClipRect(QRect(EPG_NAME_WIDTH, 0, grid.width(), EPG_HEADER_HEIGHT));
+        for (qint64 t = t0 - (t0 - m_origin) % EPG_SLOT_MS; t < t1; t += EPG_SLOT_MS) {
+            int x = EPG_NAME_WIDTH + xForTime(t) - horizontalOffset();
+            p.drawLine(x, EPG_HEADER_HEIGHT - 6, x, EPG_HEADER_HEIGHT);
+            const QStaticText &label = labelText(t);
+            p.drawStaticText(x + 4, (EPG_HEADER_HEIGHT - qRound(label.size().height())) / 2, label);
+        }
+        p.setClipping(false);
+
+        int nowX = EPG_NAME_WIDTH + xForTime(now) - horizontalOffset();
+        if (nowX >= grid.left() && nowX <= grid.right()) {
+            p.setPen(QPen(QColor(239, 68, 68), 2));
+            p.drawLine(nowX, EPG_HEADER_HEIGHT, nowX, h);
+        }
+        if (!hasGuide()) {
+            p.setPen(QColor(148, 163, 184));
+            p.drawText(grid, Qt::AlignCenter, "No programme guide for this playlist");
+        }
+    }
+
+    void showEvent(QShowEvent *event) override {
+        QAbstractItemView::showEvent(event);
+        m_nowTimer->start();
+    }
+
+    void hideEvent(QHideEvent *event) override {
+        QAbstractItemView::hideEvent(event);
+        m_nowTimer->stop();
+    }
+
+private:
+    int xForTime(qint64 t) const { return int((t - m_origin) * EPG_PIXELS_PER_MINUTE / 60000); }
+    qint64 timeForX(int x) const { return m_origin + qint64(x) * 60000 / EPG_PIXELS_PER_MINUTE; }
+
+    void resetTimeline() {
+        qint64 now = QDateTime::currentMSecsSinceEpoch();
+        m_origin = (now - EPG_PAST_MS) / EPG_SLOT_MS * EPG_SLOT_MS;
+        qint64 end = m_guide ? m_guide->end : 0;
+        m_end = qBound(m_origin + EPG_MIN_SPAN_MS, end, m_origin + EPG_MAX_SPAN_MS);
+    }
+
+    const QVector<Programme> *programmesFor(const QModelIndex &idx) const {
+        if (!m_guide) return nullptr;
+        return guideProgrammes(*m_guide, idx.data(TvgIdRole).toString(), idx.data(NameRole).toString());
+    }
+
+    QStaticText makeText(const QString &text) const {
+        QStaticText staticText(text);
+        staticText.setTextFormat(Qt::PlainText);
+        staticText.prepare(QTransform(), font());
+        return staticText;
+    }
+
+    // Cell widths only change with the guide, so a programme's elided title
+    // is laid out once.
+    const QStaticText &titleText(const Programme *programme, int width) {
+        auto it = m_titleCache.constFind(programme);
+        if (it != m_titleCache.constEnd()) return *it;
+        if (m_titleCache.size() >= EPG_TEXT_CACHE_SIZE) m_titleCache.clear();
+        return *m_titleCache.insert(programme, makeText(fontMetrics().elidedText(programme->title, Qt::ElideRight, width)));
+    }
+
+    const QStaticText &nameText(const QString &name) {
+        auto it = m_nameCache.constFind(name);
+        if (it != m_nameCache.constEnd()) return *it;
+        if (m_nameCache.size() >= EPG_TEXT_CACHE_SIZE) m_nameCache.clear();
+        return *m_nameCache.insert(name, makeText(fontMetrics().elidedText(name, Qt::ElideRight, EPG_NAME_WIDTH - 24)));
+    }
+
+    const QStaticText &labelText(qint64 t) {
+        auto it = m_labelCache.constFind(t);
+        if (it != m_labelCache.constEnd()) return *it;
+        if (m_labelCache.size() >= EPG_TEXT_CACHE_SIZE) m_labelCache.clear();
+        QDateTime local = QDateTime::fromMSecsSinceEpoch(t);
+        QString label = local.time() < QTime(0, 30) ? local.toString("ddd d") : local.toString("HH:mm");
+        return *m_labelCache.insert(t, makeText(label));
+    }
+
+    EpgGuidePtr m_guide;
+    qint64 m_origin = 0;
+    qint64 m_end = 0;
+    QTimer *m_nowTimer;
+    QHash<const Programme *, QStaticText> m_titleCache;
+    QHash<QString, QStaticText> m_nameCache;
+    QHash<qint64, QStaticText> m_labelCache;
+    QVector<QMetaObject::Connection> m_modelConnections;
+};
+
+// Per-scope p50/p99 over the last few seconds of profiler samples.
+class ProfilerOverlay : public QWidget {
+    Q_OBJECT
+public:
+    explicit ProfilerOverlay(QWidget *parent = nullptr) : QWidget(parent) {
+        setAttribute(Qt::WA_TransparentForMouseEvents);
+        setAttribute(Qt::WA_NoSystemBackground);
+        hide();
+        m_refreshTimer = new QTimer(this);
+        m_refreshTimer->setInterval(PROFILER_REFRESH_MS);
+        connect(m_refreshTimer, &QTimer::timeout, this, &ProfilerOverlay::refresh);
+    }
+
+    void toggle() {
+        if (isVisible()) {
+            m_refreshTimer->stop();
+            hide();
+            return;
+        }
+        refresh();
+        show();
+        raise();
+        m_refreshTimer->start();
+    }
+
+    // Extra lines below the scope table, refreshed from the refreshing() signal.
+    void setFooter(const QStringList &lines) { m_footer = lines; }
+
+signals:
+    void refreshing();
+
+protected:
+    void paintEvent(QPaintEvent *) override {
+        QPainter p(this);
+        p.setRenderHint(QPainter::Antialiasing);
+        QPainterPath bg;
+        bg.addRoundedRect(QRectF(rect()), 8, 8);
+        p.fillPath(bg, QColor(10, 10, 22, 220));
+
+        QFont f = p.font();
+        f.setFamily("Consolas");
+        f.setPixelSize(11);
+        p.setFont(f);
+        int y = 8;
+        p.setPen(QColor(148, 163, 184));
+        p.drawText(QRect(10, y, width() - 20, 16), Qt::AlignLeft | Qt::AlignVCenter,
+                   QString("%1 %2 %3 %4").arg("scope", -26).arg("n", 6).arg("p50 ms", 9).arg("p99 ms", 9));
+        y += 18;
+        p.setPen(QColor(240, 240, 245));
+        for (int i = 0; i < m_rows.size(); ++i) {
+            const Row &row = m_rows[i];
+            p.drawText(QRect(10, y, width() - 20, 16), Qt::AlignLeft | Qt::AlignVCenter,
+                       QString("%1 %2 %3 %4")
+                           .arg(QString::fromLatin1(row.name).left(26), -26)
+                           .arg(row.count, 6)
+                           .arg(row.p50Ms, 9, 'f', 2)
+                           .arg(row.p99Ms, 9, 'f', 2));
+            y += 16;
+        }
+        p.setPen(QColor(148, 163, 184));
+        for (int i = 0; i < m_footer.size(); ++i) {
+            p.drawText(QRect(10, y, width() - 20, 16), Qt::AlignLeft | Qt::AlignVCenter, m_footer[i]);
+            y += 16;
+        }
+    }
+
+private slots:
+    void refresh() {
+        emit refreshing();
+        qint64 since = Profiler::nowNs() - qint64(PROFILER_WINDOW_MS) * 1000000;
+        QVector<Profiler::Sample> samples = Profiler::snapshot(since);
+        QHash<QByteArray, QVector<qint64>> byName;
+        for (int i = 0; i < samples.size(); ++i) byName[QByteArray(samples[i].name)].append(samples[i].durationNs);
+
+        m_rows.clear();
+        for (auto it = byName.begin(); it != byName.end(); ++it) {
+            QVector<qint64> &d = it.value();
+            std::sort(d.begin(), d.end());
+            Row row;
+            row.name = it.key();
+            row.count = d.size();
+            row.p50Ms = d[d.size() / 2] / 1e6;
+            row.p99Ms = d[qMin(d.size() - 1, d.size() * 99 / 100)] / 1e6;
+            m_rows.append(row);
+        }
+        std::sort(m_rows.begin(), m_rows.end(), [](const Row &a, const Row &b) { return a.name < b.name; });
+        setFixedSize(420, 34 + (m_rows.size() + m_footer.size()) * 16);
+        if (parentWidget()) move(qMax(0, parentWidget()->width() - width() - 16), 8);
+        update();
+    }
+
+private:
+    struct Row {
+        QByteArray name;
+        int count = 0;
+        double p50Ms = 0;
+        double p99Ms = 0;
+    };
+
+    QTimer *m_refreshTimer;
+    QVector<Row> m_rows;
+    QStringList m_footer;
+};
+
+// Channel banner drawn by mpv itself rather than by a widget stacked over the
+// native video window. The banner is composed once per change and handed to
+// mpv with overlay-add as premultiplied BGRA, which mpv blends in its own
+// render path. Fades re-submit the banner at a new opacity; each submission
+// goes into whichever of the two buffers mpv is not reading, since mpv keeps
+// using the memory until the overlay is replaced or removed.
+class OsdOverlay : public QObject {
+    Q_OBJECT
+public:
+    explicit OsdOverlay(QWidget *surface, QObject *parent = nullptr) : QObject(parent), m_surface(surface) {
+        m_timer = new QTimer(this);
+        m_timer->setSingleShot(true);
+        connect(m_timer, &QTimer::timeout, this, &OsdOverlay::step);
+    }
+
+    void setMpv(mpv_handle *mpv) {
+        if (!mpv) hide();
+        m_mpv = mpv;
+    }
+
+    void showOsd(const QString &channelName, const QString &category, int index, int total,
+                 const QStringList &guideLines = QStringList()) {
+        m_channelName = channelName;
+        m_category = category;
+        m_index = index;
+        m_total = total;
+        m_guideLines = guideLines;
+        if (!m_mpv) return;
+        // Already on screen: swap the text in at the current opacity rather
+        // than fading in from nothing.
+        m_timelineOffset = m_front >= 0 ? qint64(m_opacity * OSD_FADE_MS) : 0;
+        m_opacity = -1.0;
+        m_clock.start();
+        compose();
+        step();
+    }
+
+    void hide() {
+        m_timer->stop();
+        m_clock.invalidate();
+        if (m_front < 0) return;
+        m_front = -1;
+        m_opacity = -1.0;
+        if (!m_mpv) return;
+        QByteArray id = QByteArray::number(OSD_OVERLAY_ID);
+        const char *cmd[] = {"overlay-remove", id.constData(), NULL};
+        mpv_command(m_mpv, cmd);
+    }
+
+    // The video surface changed size; re-place the banner if it is showing.
+    void refresh() {
+        if (m_front < 0 || !m_mpv) return;
+        compose();
+        present(m_opacity);
+    }
+
+private slots:
+    void step() {
+        if (!m_clock.isValid()) return;
+        qint64 t = m_clock.elapsed() + m_timelineOffset;
+        qreal opacity;
+        int wait = OSD_FADE_STEP_MS;
+        if (t < OSD_FADE_MS) {
+            opacity = qreal(t) / OSD_FADE_MS;
+        } else if (t < OSD_FADE_MS + OSD_DISPLAY_MS) {
+            opacity = 1.0;
+            wait = int(OSD_FADE_MS + OSD_DISPLAY_MS - t);
+        } else if (t < 2 * OSD_FADE_MS + OSD_DISPLAY_MS) {
+            opacity = 1.0 - qreal(t - OSD_FADE_MS - OSD_DISPLAY_MS) / OSD_FADE_MS;
+        } else {
+            hide();
+            return;
+        }
+        if (opacity != m_opacity) present(opacity);
+        m_timer->start(qMax(1, wait));
+    }
+
+private:
+    // Size of mpv's OSD in pixels; falls back to the widget's physical size
+    // before the first video frame has been configured.
+    QSize osdSize() const {
+        int64_t w = 0, h = 0;
+        if (m_mpv) {
+            mpv_get_property(m_mpv, "osd-width", MPV_FORMAT_INT64, &w);
+            mpv_get_property(m_mpv, "osd-height", MPV_FORMAT_INT64, &h);
+        }
+        if (w > 0 && h > 0) return QSize(int(w), int(h));
+        qreal dpr = m_surface->devicePixelRatioF();
+        return QSize(qRound(m_surface->width() * dpr), qRound(m_surface->height() * dpr));
+    }
+
+    // Draws the banner at full opacity in widget units scaled to OSD pixels,
+    // with the same layout the old overlay widget used.
+    void compose() {
+        QSize osd = osdSize();
+        qreal scale = m_surface->width() > 0 ? qreal(osd.width()) / m_surface->width() : 1.0;
+        int logicalW = qRound(osd.width() / scale);
+        int logicalH = qRound(osd.height() / scale);
+        int boxW = qMin(logicalW - 60, 520);
+        int boxH = m_guideLines.isEmpty() ? 90 : 90 + 20 * m_guideLines.size();
+        if (boxW <= 60 || boxH >= logicalH) {
+            m_banner = QImage();
+            return;
+        }
+        m_bannerPos = QPoint(qRound((logicalW - boxW) / 2 * scale), qRound((logicalH - boxH - 50) * scale));
+        m_banner = QImage(qRound(boxW * scale), qRound(boxH * scale), QImage::Format_ARGB32_Premultiplied);
+        m_banner.fill(Qt::transparent);
+
+        QPainter p(&m_banner);
+        p.setRenderHint(QPainter::Antialiasing);
+        p.scale(scale, scale);
+
+        QPainterPath bgPath;
+        bgPath.addRoundedRect(QRectF(0.5, 0.5, boxW - 1, boxH - 1), 16, 16);
+        p.fillPath(bgPath, QColor(15, 15, 30, 210));
+        p.setPen(QPen(QColor(255, 255, 255, 30), 1));
+        p.drawPath(bgPath);
+
+        p.setPen(Qt::NoPen);
+        p.setBrush(QColor(99, 102, 241));
+        p.drawRoundedRect(16, 14, 4, boxH - 28, 2, 2);
+
+        p.setPen(Qt::white);
+        QFont f = m_surface->font();
+        f.setPixelSize(20);
+        f.setBold(true);
+        p.setFont(f);
+        QString elidedName = p.fontMetrics().elidedText(m_channelName, Qt::ElideRight, boxW - 50);
+        p.drawText(30, 16, boxW - 50, 30, Qt::AlignLeft | Qt::AlignVCenter, elidedName);
+
+        f.setPixelSize(13);
+        f.setBold(false);
+        p.setFont(f);
+        p.setPen(QColor(165, 180, 210));
+        QString info = m_category;
+        if (m_total > 0) info += QString("  |  %1 of %2").arg(m_index + 1).arg(m_total);
+        p.drawText(30, 50, boxW - 50, 24, Qt::AlignLeft | Qt::AlignVCenter, info);
+
+        p.setPen(QColor(203, 213, 225));
+        for (int i = 0; i < m_guideLines.size(); ++i) {
+            QString line = p.fontMetrics().elidedText(m_guideLines[i], Qt::ElideRight, boxW - 50);
+            p.drawText(30, 74 + 20 * i, boxW - 50, 20, Qt::AlignLeft | Qt::AlignVCenter, line);
+        }
+    }
+
+    void present(qreal opacity) {
+        m_opacity = opacity;
+        if (!m_mpv || m_banner.isNull()) return;
+        int back = m_front == 0 ? 1 : 0;
+        QImage &buffer = m_buffers[back];
+        if (buffer.size() != m_banner.size()) buffer = QImage(m_banner.size(), QImage::Format_ARGB32_Premultiplied);
+        buffer.fill(Qt::transparent);
+        {
+            QPainter p(&buffer);
+            p.setOpacity(opacity);
+            p.drawImage(0, 0, m_banner);
+        }
+
+        // Format_ARGB32_Premultiplied is B, G, R, A in memory on
+        // little-endian hosts, which is mpv's "bgra".
+        QByteArray id = QByteArray::number(OSD_OVERLAY_ID);
+        QByteArray x = QByteArray::number(m_bannerPos.x());
+        QByteArray y = QByteArray::number(m_bannerPos.y());
+        QByteArray file = "&" + QByteArray::number(quintptr(buffer.constBits()));
+        QByteArray w = QByteArray::number(buffer.width());
+        QByteArray h = QByteArray::number(buffer.height());
+        QByteArray stride = QByteArray::number(buffer.bytesPerLine());
+        const char *cmd[] = {"overlay-add", id.constData(), x.constData(), y.constData(), file.constData(),
+                             "0", "bgra", w.constData(), h.constData(), stride.constData(), NULL};
+        if (mpv_command(m_mpv, cmd) >= 0) m_front = back;
+    }
+
+    QWidget *m_surface;
+    mpv_handle *m_mpv = nullptr;
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_timelineOffset = 0;
+    QImage m_banner;
+    QPoint m_bannerPos;
+    QImage m_buffers[2];
+    int m_front = -1;
+    qreal m_opacity = -1.0;
+    QString m_channelName;
+    QString m_category;
+    QStringList m_guideLines;
+    int m_index = 0;
+    int m_total = 0;
+};
+
+// Drives an mpv_render_context with the software API: mpv renders each
+// frame into a QImage that is reused until the requested size changes.
+class SoftwareRenderer : public QObject {
+    Q_OBJECT
+public:
+    explicit SoftwareRenderer(QObject *parent = nullptr) : QObject(parent) {}
+    ~SoftwareRenderer() override { release(); }
+
+    bool init(mpv_handle *mpv) {
+        mpv_render_param params[] = {
+            {MPV_RENDER_PARAM_API_TYPE, const_cast<char *>(MPV_RENDER_API_TYPE_SW)},
+            {MPV_RENDER_PARAM_INVALID, nullptr}};
+        if (mpv_render_context_create(&m_ctx, mpv, params) < 0) {
+            m_ctx = nullptr;
+            return false;
+        }
+        mpv_render_context_set_update_callback(m_ctx, [](void *ctx) {
+            QMetaObject::invokeMethod(static_cast<SoftwareRenderer *>(ctx), "onUpdate", Qt::QueuedConnection);
+        }, this);
+        return true;
+    }
+
+    // Must run before the owning mpv_handle is destroyed.
+    void release() {
+        if (!m_ctx) return;
+        mpv_render_context_set_update_callback(m_ctx, nullptr, nullptr);
+        mpv_render_context_free(m_ctx);
+        m_ctx = nullptr;
+    }
+
+    bool render(const QSize &size) {
+        if (!m_ctx || size.isEmpty()) return false;
+        if (m_image.size() != size) m_image = QImage(size, QImage::Format_RGB32);
+        int sw[2] = {size.width(), size.height()};
+        size_t stride = static_cast<size_t>(m_image.bytesPerLine());
+        // Rendering runs on the GUI thread from paintEvent; it must hand back
+        // the current frame at once rather than sleep until its display time.
+        int block = 0;
+        mpv_render_param params[] = {
+            {MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block},
+            {MPV_RENDER_PARAM_SW_SIZE, sw},
+            {MPV_RENDER_PARAM_SW_FORMAT, const_cast<char *>("bgr0")},
+            {MPV_RENDER_PARAM_SW_STRIDE, &stride},
+            {MPV_RENDER_PARAM_SW_POINTER, m_image.bits()},
+            {MPV_RENDER_PARAM_INVALID, nullptr}};
+        return mpv_render_context_render(m_ctx, params) >= 0;
+    }
+
+    void reportSwap() {
+        if (m_ctx) mpv_render_context_report_swap(m_ctx);
+    }
+
+    const QImage &image() const { return m_image; }
+    bool isValid() const { return m_ctx != nullptr; }
+
+signals:
+    void frameReady();
+
+private slots:
+    void onUpdate() {
+        if (m_ctx && (mpv_render_context_update(m_ctx) & MPV_RENDER_UPDATE_FRAME)) emit frameReady();
+    }
+
+private:
+    mpv_render_context *m_ctx = nullptr;
+    QImage m_image;
+};
+
+class VideoWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit VideoWidget(QWidget *parent = nullptr) : QWidget(parent) {
+        // Only made native when mpv draws into it through wid; software
+        // rendering paints it like any other widget.
+        setAttribute(Qt::WA_DontCreateNativeAncestors);
+        setMinimumSize(320, 240);
+        QPalette pal = palette();
+        pal.setColor(QPalette::Window, Qt::black);
+        setPalette(pal);
+        setAutoFillBackground(true);
+        setFocusPolicy(Qt::NoFocus);
+        setMouseTracking(true);
+
+        m_frameTimer = new QTimer(this);
+        m_frameTimer->setSingleShot(true);
+        connect(m_frameTimer, &QTimer::timeout, this, [this]() { update(); });
+    }
+
+    // Paints frames from a software renderer instead of letting mpv draw
+    // into the native window. scale shrinks the render target to save CPU;
+    // the frame is stretched back to the widget on paint.
+    void setSoftwareRenderer(SoftwareRenderer *renderer, qreal scale) {
+        m_renderer = renderer;
+        m_renderScale = qBound<qreal>(0.1, scale, 1.0);
+        setAttribute(Qt::WA_OpaquePaintEvent, renderer != nullptr);
+        QScreen *screen = QGuiApplication::primaryScreen();
+        qreal hz = screen ? screen->refreshRate() : 0.0;
+        m_frameIntervalMs = hz > 1.0 ? qMax(1, static_cast<int>(1000.0 / hz)) : DEFAULT_FRAME_INTERVAL_MS;
+        if (renderer) connect(renderer, &SoftwareRenderer::frameReady, this, &VideoWidget::scheduleFrame);
+    }
+
+signals:
+    void doubleClicked();
+
+protected:
+    void mouseDoubleClickEvent(QMouseEvent *event) override {
+        emit doubleClicked();
+        QWidget::mouseDoubleClickEvent(event);
+    }
+
+    void paintEvent(QPaintEvent *event) override {
+        if (!m_renderer) {
+            QWidget::paintEvent(event);
+            return;
+        }
+        ProfileScope scope("VideoWidget::frame");
+        QPainter p(this);
+        QSize target = (QSizeF(size()) * devicePixelRatioF() * m_renderScale).toSize();
+        if (m_renderer->render(target)) {
+            p.drawImage(rect(), m_renderer->image());
+            m_renderer->reportSwap();
+        } else {
+            p.fillRect(rect(), Qt::black);
+        }
+        m_frameClock.start();
+    }
+
+private slots:
+    // Coalesces mpv's frame notifications to at most one repaint per
+    // display refresh.
+    void scheduleFrame() {
+        if (m_frameTimer->isActive()) return;
+        qint64 since = m_frameClock.isValid() ? m_frameClock.elapsed() : m_frameIntervalMs;
+        if (since >= m_frameIntervalMs) {
+            update();
+        } else {
+            m_frameTimer->start(static_cast<int>(m_frameIntervalMs - since));
+        }
+    }
+
+private:
+    SoftwareRenderer *m_renderer = nullptr;
+    QTimer *m_frameTimer;
+    QElapsedTimer m_frameClock;
+    qreal m_renderScale = 1.0;
+    int m_frameIntervalMs = DEFAULT_FRAME_INTERVAL_MS;
+};
+
+class StatusIndicator : public QWidget {
+    Q_OBJECT
+    Q_PROPERTY(QColor dotColor READ dotColor WRITE setDotColor)
+public:
+    enum Status { Offline, Connecting, Online };
+
+    explicit StatusIndicator(QWidget *parent = nullptr) : QWidget(parent), m_status(Offline) {
+        setFixedSize(140, 32);
+        m_dotColor = QColor(239, 68, 68);
+        m_pulseTimer = new QTimer(this);
+        m_pulseTimer->setInterval(1200);
+        connect(m_pulseTimer, &QTimer::timeout, this, [this]() {
+            m_pulsePhase = !m_pulsePhase;
+            update();
+        });
+    }
+
+    void setStatus(Status s) {
+        m_status = s;
+        switch (s) {
+            case Offline:
+                m_dotColor = QColor(239, 68, 68);
+                m_statusText = "Offline";
+                m_pulseTimer->stop();
+                break;
+            case Connecting:
+                m_dotColor = QColor(251, 191, 36);
+                m_statusText = "Connecting...";
+                if (m_animated) m_pulseTimer->start();
+                break;
+            case Online:
+                m_dotColor = QColor(34, 197, 94);
+                m_statusText = "Online";
+                m_pulseTimer->stop();
+                break;
+        }
+        update();
+    }
+
+    void setAnimated(bool animated) {
+        m_animated = animated;
+        if (!animated) {
+            m_pulseTimer->stop();
+            m_pulsePhase = false;
+        } else if (m_status == Connecting) {
+            m_pulseTimer->start();
+        }
+        update();
+    }
+
+    Status status() const { return m_status; }
+    QColor dotColor() const { return m_dotColor; }
+    void setDotColor(const QColor &c) { m_dotColor = c; update(); }
+
+protected:
+    void paintEvent(QPaintEvent *) override {
+        QPainter p(this);
+        p.setRenderHint(QPainter::Antialiasing);
+
+        QPainterPath bg;
+        bg.addRoundedRect(rect().adjusted(1, 1, -1, -1), 14, 14);
+        p.fillPath(bg, QColor(30, 32, 48, 200));
+        p.setPen(QPen(QColor(255, 255, 255, 20), 1));
+        p.drawPath(bg);
+
+        int dotX = 16, dotY = height() / 2;
+        if (m_status == Connecting && m_pulsePhase) {
+            p.setPen(Qt::NoPen);
+            QColor pulse = m_dotColor;
+            pulse.setAlpha(60);
+            p.setBrush(pulse);
+            p.drawEllipse(QPoint(dotX, dotY), 8, 8);
+        }
+
+        p.setPen(Qt::NoPen);
+        p.setBrush(m_dotColor);
+        p.drawEllipse(QPoint(dotX, dotY), 5, 5);
+
+        p.setPen(QColor(220, 225, 235));
+        QFont f = font();
+        f.setPixelSize(11);
+        f.setBold(true);
+        p.setFont(f);
+        p.drawText(QRect(30, 0, width() - 36, height()), Qt::AlignLeft | Qt::AlignVCenter, m_statusText);
+    }
+
+private:
+    Status m_status;
+    QColor m_dotColor;
+    QString m_statusText = "Offline";
+    QTimer *m_pulseTimer;
+    bool m_pulsePhase = false;
+    bool m_animated = true;
+};
+
+// Header strip behind the search box and transport buttons: a vertical
+// gradient with a hairline along the bottom edge.
+class HeaderBar : public QWidget {
+    Q_OBJECT
+public:
+    explicit HeaderBar(QWidget *parent = nullptr) : QWidget(parent) {}
+
+protected:
+    void paintEvent(QPaintEvent *) override {
+        QPainter p(this);
+        QLinearGradient grad(0, 0, 0, height());
+        grad.setColorAt(0, QColor(0x1a, 0x1a, 0x2e));
+        grad.setColorAt(1, QColor(0x16, 0x16, 0x2a));
+        p.fillRect(rect(), grad);
+        p.fillRect(QRect(0, height() - 1, width(), 1), QColor(255, 255, 255, 15));
+    }
+};
+
+// Application theme: Fusion with a dark palette, plus the rounded panels,
+// thin scroll bars and list highlights the palette cannot express. Widgets
+// that need their own font or colours are picked out by object name once,
+// when they are polished, so nothing goes through QStyleSheetStyle at
+// paint time.
+class ModernStyle : public QProxyStyle {
+    Q_OBJECT
+public:
+    ModernStyle() : QProxyStyle(QStyleFactory::create("Fusion")) {}
+
+    static QPalette themePalette() {
+        const QColor background(0x0f, 0x0f, 0x1a);
+        const QColor text(0xe2, 0xe8, 0xf0);
+        const QColor muted(0x64, 0x74, 0x8b);
+        QPalette pal;
+        pal.setColor(QPalette::Window, background);
+        pal.setColor(QPalette::WindowText, text);
+        pal.setColor(QPalette::Base, background);
+        pal.setColor(QPalette::AlternateBase, QColor(0x12, 0x12, 0x1f));
+        pal.setColor(QPalette::Text, text);
+        pal.setColor(QPalette::Button, QColor(0x1e, 0x1e, 0x35));
+        pal.setColor(QPalette::ButtonText, text);
+        pal.setColor(QPalette::BrightText, Qt::white);
+        pal.setColor(QPalette::Highlight, QColor(0x63, 0x66, 0xf1));
+        pal.setColor(QPalette::HighlightedText, Qt::white);
+        pal.setColor(QPalette::ToolTipBase, background);
+        pal.setColor(QPalette::ToolTipText, text);
+        pal.setColor(QPalette::Link, QColor(0xa5, 0xb4, 0xfc));
+        pal.setColor(QPalette::Disabled, QPalette::WindowText, muted);
+        pal.setColor(QPalette::Disabled, QPalette::Text, muted);
+        pal.setColor(QPalette::Disabled, QPalette::ButtonText, muted);
+        return pal;
+    }
+
+    static QFont themeFont(int pixelSize = 0, QFont::Weight weight = QFont::Normal) {
+        QFont font = QApplication::font();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+        font.setFamilies({"Segoe UI", "SF Pro Display", "Helvetica Neue", "Arial"});
+#else
+        font.setFamily("Segoe UI");
+#endif
+        if (pixelSize > 0) font.setPixelSize(pixelSize);
+        font.setWeight(weight);
+        return font;
+    }
+
+    // Palette and font go in before the style so the first polish already
+    // sees them.
+    static void install() {
+        QPalette pal = themePalette();
+        QApplication::setPalette(pal);
+        QToolTip::setPalette(pal);
+        QApplication::setFont(themeFont());
+        QApplication::setStyle(new ModernStyle);
+    }
+
+    void polish(QWidget *w) override {
+        QProxyStyle::polish(w);
+        if (QAbstractItemView *view = qobject_cast<QAbstractItemView *>(w))
+            view->viewport()->setAttribute(Qt::WA_Hover);
+        if (qobject_cast<QStatusBar *>(w)) {
+            setLook(w, themeFont(11), QColor(0x64, 0x74, 0x8b));
+            return;
+        }
+
+        const QString name = w->objectName();
+        if (name.isEmpty()) return;
+        if (name == "appTitle") {
+            setLook(w, themeFont(16, QFont::Bold), QColor(0xf1, 0xf5, 0xf9));
+        } else if (name == "searchEdit") {
+            setLook(w, themeFont(13), QColor(0xe2, 0xe8, 0xf0));
+            if (QLineEdit *edit = qobject_cast<QLineEdit *>(w)) edit->setTextMargins(8, 0, 8, 0);
+        } else if (name == "sortCombo") {
+            setLook(w, themeFont(12), QColor(0xe2, 0xe8, 0xf0));
+            if (QComboBox *combo = qobject_cast<QComboBox *>(w)) {
+                QPalette pal = combo->view()->palette();
+                pal.setColor(QPalette::Base, QColor(0x1e, 0x1e, 0x35));
+                pal.setColor(QPalette::Window, QColor(0x1e, 0x1e, 0x35));
+                combo->view()->setPalette(pal);
+            }
+        } else if (name == "nowPlaying") {
+            setLook(w, themeFont(12, QFont::DemiBold), QColor(0xa5, 0xb4, 0xfc));
+        } else if (name == "channelCount") {
+            setLook(w, themeFont(11), QColor(0x64, 0x74, 0x8b));
+        } else if (name == "volumeLabel") {
+            setLook(w, themeFont(11, QFont::DemiBold), QColor(0x94, 0xa3, 0xb8));
+        } else if (name == "iconBtn") {
+            setLook(w, themeFont(14), QColor(0xe2, 0xe8, 0xf0));
+        } else if (name == "refreshBtn") {
+            setLook(w, themeFont(12, QFont::DemiBold), QColor(0xa5, 0xb4, 0xfc));
+        } else if (name == "leftPanel") {
+            QPalette pal = w->palette();
+            pal.setColor(QPalette::Window, QColor(0x12, 0x12, 0x1f));
+            w->setPalette(pal);
+            w->setAutoFillBackground(true);
+        } else if (name == "sectionTitle") {
+            QFont font = themeFont(13, QFont::Bold);
+            font.setCapitalization(QFont::AllUppercase);
+            font.setLetterSpacing(QFont::AbsoluteSpacing, 1);
+            setLook(w, font, QColor(0x94, 0xa3, 0xb8));
+            w->setContentsMargins(8, 4, 8, 4);
+        } else if (name == "categoryList") {
+            setLook(w, themeFont(13), QColor(0xcb, 0xd5, 0xe1));
+            QPalette pal = w->palette();
+            pal.setColor(QPalette::Base, Qt::transparent);
+            pal.setColor(QPalette::HighlightedText, QColor(0xe0, 0xe7, 0xff));
+            w->setPalette(pal);
+            if (QFrame *frame = qobject_cast<QFrame *>(w)) frame->setFrameShape(QFrame::NoFrame);
+        } else if (name == "channelGrid") {
+            if (QFrame *frame = qobject_cast<QFrame *>(w)) frame->setFrameShape(QFrame::NoFrame);
+        }
+    }
+
+    int pixelMetric(PixelMetric pm, const QStyleOption *opt, const QWidget *w) const override {
+        switch (pm) {
+            case PM_SplitterWidth:
+                if (const QSplitter *splitter = qobject_cast<const QSplitter *>(w))
+                    return splitter->orientation() == Qt::Horizontal ? 1 : 4;
+                break;
+            case PM_ScrollBarExtent:
+                return 8;
+            case PM_ScrollBarSliderMin:
+                return 30;
+            default:
+                break;
+        }
+        return QProxyStyle::pixelMetric(pm, opt, w);
+    }
+
+    QSize sizeFromContents(ContentsType ct, const QStyleOption *opt, const QSize &size,
+                           const QWidget *w) const override {
+        QSize s = QProxyStyle::sizeFromContents(ct, opt, size, w);
+        const QString name = w ? w->objectName() : QString();
+        if (ct == CT_ItemViewItem && name == "categoryList") return s + QSize(32, 18);
+        if (ct == CT_PushButton && name == "refreshBtn") return QSize(s.width(), size.height() + 18);
+        if (ct == CT_LineEdit && name == "searchEdit") return QSize(s.width(), size.height() + 14);
+        if (ct == CT_ComboBox && name == "sortCombo")
+            return QSize(s.width() + 8, qMax(s.height(), size.height() + 12));
+        return s;
+    }
+
+    QRect subElementRect(SubElement se, const QStyleOption *opt, const QWidget *w) const override {
+        QRect r = QProxyStyle::subElementRect(se, opt, w);
+        if (se == SE_ItemViewItemText && w && w->objectName() == "categoryList") r.adjust(12, 0, -12, 0);
+        return r;
+    }
+
+    QRect subControlRect(ComplexControl cc, const QStyleOptionComplex *opt, SubControl sc,
+                         const QWidget *w) const override {
+        if (cc == CC_ScrollBar) {
+            if (const QStyleOptionSlider *bar = qstyleoption_cast<const QStyleOptionSlider *>(opt))
+                return scrollBarRect(bar, sc, w);
+        }
+        return QProxyStyle::subControlRect(cc, opt, sc, w);
+    }
+
+    void drawPrimitive(PrimitiveElement pe, const QStyleOption *opt, QPainter *p,
+                       const QWidget *w) const override {
+        const QString name = w ? w->objectName() : QString();
+        switch (pe) {
+            case PE_PanelLineEdit:
+                if (name == "searchEdit") {
+                    bool focused = opt->state & State_HasFocus;
+                    drawRoundedPanel(p, opt->rect, 8, focused ? QColor(0x22, 0x22, 0x40) : QColor(0x1e, 0x1e, 0x35),
+                                     focused ? QColor(0x63, 0x66, 0xf1) : QColor(255, 255, 255, 26));
+                    return;
+                }
+                break;
+            case PE_FrameLineEdit:
+                if (name == "searchEdit") return;
+                break;
+            case PE_PanelItemViewItem:
+                if (name == "categoryList") {
+                    drawCategoryItem(opt, p);
+                    return;
+                }
+                break;
+            case PE_FrameFocusRect:
+                if (name == "categoryList" || name == "iconBtn" || name == "refreshBtn") return;
+                break;
+            case PE_PanelStatusBar:
+                p->fillRect(opt->rect, QColor(0x0a, 0x0a, 0x16));
+                p->fillRect(QRect(opt->rect.left(), opt->rect.top(), opt->rect.width(), 1), QColor(255, 255, 255, 10));
+                return;
+            default:
+                break;
+        }
+        QProxyStyle::drawPrimitive(pe, opt, p, w);
+    }
+
+    void drawControl(ControlElement ce, const QStyleOption *opt, QPainter *p, const QWidget *w) const override {
+        const QString name = w ? w->objectName() : QString();
+        switch (ce) {
+            case CE_PushButtonBevel:
+                if (name == "iconBtn" || name == "refreshBtn") {
+                    drawButtonPanel(name == "refreshBtn", opt, p);
+                    return;
+                }
+                break;
+            case CE_PushButtonLabel:
+                if (name == "refreshBtn" && (opt->state & State_MouseOver)) {
+                    if (const QStyleOptionButton *button = qstyleoption_cast<const QStyleOptionButton *>(opt)) {
+                        QStyleOptionButton hovered(*button);
+                        hovered.palette.setColor(QPalette::ButtonText, QColor(0xe0, 0xe7, 0xff));
+                        QProxyStyle::drawControl(ce, &hovered, p, w);
+                        return;
+                    }
+                }
+                break;
+            case CE_Splitter:
+                p->fillRect(opt->rect, (opt->state & State_MouseOver) ? QColor(99, 102, 241, 102)
+                                                                       : QColor(255, 255, 255, 10));
+                return;
+            case CE_ShapedFrame:
+                if (name == "headerSep") {
+                    p->fillRect(opt->rect, QColor(255, 255, 255, 10));
+                    return;
+                }
+                break;
+            default:
+                break;
+        }
+        QProxyStyle::drawControl(ce, opt, p, w);
+    }
+
+    void drawComplexControl(ComplexControl cc, const QStyleOptionComplex *opt, QPainter *p,
+                            const QWidget *w) const override {
+        if (cc == CC_ScrollBar) {
+            if (const QStyleOptionSlider *bar = qstyleoption_cast<const QStyleOptionSlider *>(opt)) {
+                bool hot = (bar->activeSubControls & SC_ScrollBarSlider) &&
+                           (bar->state & (State_MouseOver | State_Sunken));
+                QRect handle = scrollBarRect(bar, SC_ScrollBarSlider, w);
+                p->save();
+                p->setRenderHint(QPainter::Antialiasing);
+                p->setPen(Qt::NoPen);
+                p->setBrush(QColor(148, 163, 184, hot ? 89 : 51));
+                p->drawRoundedRect(handle, 4, 4);
+                p->restore();
+                return;
+            }
+        }
+        if (cc == CC_ComboBox && w && w->objectName() == "sortCombo") {
+            if (const QStyleOptionComboBox *combo = qstyleoption_cast<const QStyleOptionComboBox *>(opt)) {
+                drawRoundedPanel(p, combo->rect, 8, QColor(0x1e, 0x1e, 0x35), QColor(255, 255, 255, 26));
+                QStyleOption arrow(*combo);
+                arrow.rect = subControlRect(cc, combo, SC_ComboBoxArrow, w).adjusted(4, 0, -4, 0);
+                proxy()->drawPrimitive(PE_IndicatorArrowDown, &arrow, p, w);
+                return;
+            }
+        }
+        QProxyStyle::drawComplexControl(cc, opt, p, w);
+    }
+
+private:
+    static void setLook(QWidget *w, const QFont &font, const QColor &text) {
+        w->setFont(font);
+        QPalette pal = w->palette();
+        pal.setColor(QPalette::WindowText, text);
+        pal.setColor(QPalette::ButtonText, text);
+        pal.setColor(QPalette::Text, text);
+        w->setPalette(pal);
+    }
+
+    static void drawRoundedPanel(QPainter *p, const QRect &rect, qreal radius, const QColor &fill,
+                                 const QColor &border) {
+        p->save();
+        p->setRenderHint(QPainter::Antialiasing);
+        p->setPen(QPen(border, 1));
+        p->setBrush(fill);
+        p->drawRoundedRect(QRectF(rect).adjusted(0.5, 0.5, -0.5, -0.5), radius, radius);
+        p->restore();
+    }
+
+    static void drawButtonPanel(bool accent, const QStyleOption *opt, QPainter *p) {
+        bool pressed = opt->state & (State_Sunken | State_On);
+        bool hover = opt->state & State_MouseOver;
+        QColor fill, border;
+        if (accent) {
+            fill = QColor(99, 102, 241, hover || pressed ? 77 : 38);
+            border = QColor(99, 102, 241, 64);
+        } else if (pressed) {
+            fill = QColor(99, 102, 241, 128);
+            border = QColor(99, 102, 241, 128);
+        } else if (hover) {
+            fill = QColor(99, 102, 241, 77);
+            border = QColor(99, 102, 241, 128);
+        } else {
+            fill = QColor(255, 255, 255, 13);
+            border = QColor(255, 255, 255, 20);
+        }
+        drawRoundedPanel(p, opt->rect, accent ? 8 : 6, fill, border);
+    }
+
+    // Inset pill; the selected row gets a horizontal fade and an accent bar
+    // down its left edge.
+    static void drawCategoryItem(const QStyleOption *opt, QPainter *p) {
+        bool selected = opt->state & State_Selected;
+        if (!selected && !(opt->state & State_MouseOver)) return;
+        QRectF r = QRectF(opt->rect).adjusted(4, 1, -4, -1);
+        QPainterPath path;
+        path.addRoundedRect(r, 8, 8);
+        p->save();
+        p->setRenderHint(QPainter::Antialiasing);
+        if (selected) {
+            QLinearGradient grad(r.topLeft(), r.topRight());
+            grad.setColorAt(0, QColor(99, 102, 241, 89));
+            grad.setColorAt(1, QColor(99, 102, 241, 38));
+            p->fillPath(path, grad);
+            p->setClipPath(path);
+            p->fillRect(QRectF(r.left(), r.top(), 3, r.height()), QColor(0x63, 0x66, 0xf1));
+        } else {
+            p->fillPath(path, QColor(255, 255, 255, 10));
+        }
+        p->restore();
+    }
+
+    // Scroll bars have no step buttons: the groove is the whole bar.
+    QRect scrollBarRect(const QStyleOptionSlider *bar, SubControl sc, const QWidget *w) const {
+        const QRect r = bar->rect;
+        bool horizontal = bar->orientation == Qt::Horizontal;
+        int length = horizontal ? r.width() : r.height();
+        int range = bar->maximum - bar->minimum;
+        int handle = range > 0 ? int(qint64(length) * bar->pageStep / (qint64(range) + bar->pageStep)) : length;
+        handle = qBound(qMin(proxy()->pixelMetric(PM_ScrollBarSliderMin, bar, w), length), handle, length);
+        int pos = sliderPositionFromValue(bar->minimum, bar->maximum, bar->sliderPosition, length - handle,
+                                          bar->upsideDown);
+        auto span = [&](int start, int size) {
+            return horizontal ? QRect(r.left() + start, r.top(), size, r.height())
+                              : QRect(r.left(), r.top() + start, r.width(), size);
+        };
+        switch (sc) {
+            case SC_ScrollBarSlider:
+                return span(pos, handle);
+            case SC_ScrollBarSubPage:
+                return span(0, pos);
+            case SC_ScrollBarAddPage:
+                return span(pos + handle, length - pos - handle);
+            case SC_ScrollBarGroove:
+                return r;
+            default:
+                return QRect();
+        }
+    }
+};
+
+static qint64 processCpuMs() {
+#ifdef Q_OS_WIN
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return static_cast<qint64>((k.QuadPart + u.QuadPart) / 10000);
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000LL +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000;
+#endif
+}
+
+static qint64 processRssBytes() {
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+    return static_cast<qint64>(pmc.WorkingSetSize);
+#else
+    QFile f("/proc/self/statm");
+    if (!f.open(QIODevice::ReadOnly)) return 0;
+    QList<QByteArray> fields = f.readAll().split(' ');
+    if (fields.size() < 2) return 0;
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+// Decides how much background work the app should do, from window state and
+// time since the last user input; MainWindow applies each state. It also
+// counts event loop wakeups per state, and the RSS around memory shedding,
+// so the effect shows up in the profiler overlay.
+class ActivityGovernor : public QObject {
+    Q_OBJECT
+public:
+    enum State { Active, Idle, Fullscreen, Background };
+
+    explicit ActivityGovernor(QObject *parent = nullptr) : QObject(parent) {
+        m_lastInput.start();
+        m_stateClock.start();
+
+        // Fires once per idle period at most; input only stamps a clock.
+        m_idleTimer = new QTimer(this);
+        m_idleTimer->setSingleShot(true);
+        connect(m_idleTimer, &QTimer::timeout, this, &ActivityGovernor::reevaluate);
+        m_idleTimer->start(GOVERNOR_IDLE_MS);
+
+        m_shedTimer = new QTimer(this);
+        m_shedTimer->setSingleShot(true);
+        m_shedTimer->setInterval(GOVERNOR_SHED_DELAY_MS);
+        connect(m_shedTimer, &QTimer::timeout, this, &ActivityGovernor::shed);
+
+        if (QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance()) {
+            connect(dispatcher, &QAbstractEventDispatcher::awake, this, [this]() { m_wakeups++; });
+        }
+        qApp->installEventFilter(this);
+    }
+
+    State state() const { return m_state; }
+
+    void setWindowState(bool background, bool fullscreen) {
+        m_background = background;
+        m_fullscreen = fullscreen;
+        reevaluate();
+    }
+
+    QStringList report() const {
+        static const char *const names[] = {"active", "idle", "fullscreen", "background"};
+        QStringList lines;
+        lines << QString("activity: %1, %2 wakeups/s").arg(names[m_state]).arg(currentRate(), 0, 'f', 1);
+        for (int i = 0; i < 4; ++i) {
+            if (i == m_state || m_lastRate[i] < 0) continue;
+            lines << QString("  last %1: %2 wakeups/s").arg(names[i]).arg(m_lastRate[i], 0, 'f', 1);
+        }
+        if (m_rssBefore > 0) {
+            lines << QString("shed: RSS %1 MB -> %2 MB")
+                         .arg(m_rssBefore / (1024.0 * 1024.0), 0, 'f', 1)
+                         .arg(m_rssAfter / (1024.0 * 1024.0), 0, 'f', 1);
+        }
+        return lines;
+    }
+
+signals:
+    void stateChanged(ActivityGovernor::State state);
+    void shedRequested();
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event) override {
+        switch (event->type()) {
+            case QEvent::MouseMove:
+            case QEvent::MouseButtonPress:
+            case QEvent::KeyPress:
+            case QEvent::Wheel:
+                m_lastInput.restart();
+                if (m_state == Idle) reevaluate();
+                break;
+            default:
+                break;
+        }
+        return QObject::eventFilter(obj, event);
+    }
+
+private slots:
+    void reevaluate() {
+        qint64 idleFor = m_lastInput.elapsed();
+        State next = Active;
+        if (m_background) next = Background;
+        else if (m_fullscreen) next = Fullscreen;
+        else if (idleFor >= GOVERNOR_IDLE_MS) next = Idle;
+        if (next == Active) m_idleTimer->start(static_cast<int>(GOVERNOR_IDLE_MS - idleFor));
+        if (next == m_state) return;
+
+        m_lastRate[m_state] = currentRate();
+        m_wakeupsAtState = m_wakeups;
+        m_stateClock.restart();
+        m_state = next;
+        if (next == Background) m_shedTimer->start();
+        else m_shedTimer->stop();
+        emit stateChanged(next);
+    }
+
+    // Only worth it when there is something to give back.
+    void shed() {
+        qint64 rss = processRssBytes();
+        if (rss < GOVERNOR_SHED_RSS_BYTES) return;
+        m_rssBefore = rss;
+        m_rssAfter = rss;
+        emit shedRequested();
+        QTimer::singleShot(GOVERNOR_RSS_SETTLE_MS, this, [this]() { m_rssAfter = processRssBytes(); });
+    }
+
+private:
+    double currentRate() const {
+        return (m_wakeups - m_wakeupsAtState) * 1000.0 / qMax<qint64>(1, m_stateClock.elapsed());
+    }
+
+    State m_state = Active;
+    bool m_background = false;
+    bool m_fullscreen = false;
+    QElapsedTimer m_lastInput;
+    QElapsedTimer m_stateClock;
+    QTimer *m_idleTimer;
+    QTimer *m_shedTimer;
+    qint64 m_wakeups = 0;
+    qint64 m_wakeupsAtState = 0;
+    double m_lastRate[4] = {-1, -1, -1, -1};
+    qint64 m_rssBefore = 0;
+    qint64 m_rssAfter = 0;
+};
+
+// Grabs one small frame from each channel on screen with a private,
+// video-only mpv instance drawn through the software render API. Only one
+// stream is open at a time, decoding keyframes only from the lowest HLS
+// variant, and the pause between grabs is stretched so that time spent
+// with a stream open stays under PREVIEW_CPU_PERCENT of wall time. The
+// main player is never touched.
+class PreviewGrabber : public QObject {
+    Q_OBJECT
+public:
+    explicit PreviewGrabber(qreal dpr, QObject *parent = nullptr) : QObject(parent), m_dpr(dpr) {
+        m_nextTimer = new QTimer(this);
+        m_nextTimer->setSingleShot(true);
+        connect(m_nextTimer, &QTimer::timeout, this, &PreviewGrabber::grabNext);
+
+        m_timeoutTimer = new QTimer(this);
+        m_timeoutTimer->setSingleShot(true);
+        m_timeoutTimer->setInterval(PREVIEW_GRAB_TIMEOUT_MS);
+        connect(m_timeoutTimer, &QTimer::timeout, this, [this]() { finishGrab(false); });
+    }
+
+    ~PreviewGrabber() override { shutdown(); }
+
+    const QHash<QString, QPixmap> *previews() const { return &m_previews; }
+    bool isEnabled() const { return m_enabled; }
+
+    // The mpv instance only exists while previews are enabled.
+    void setEnabled(bool enabled) {
+        if (enabled == m_enabled) return;
+        m_enabled = enabled;
+        if (!enabled) {
+            shutdown();
+            m_previews.clear();
+            m_grabbedAt.clear();
+        }
+        reschedule();
+    }
+
+    // Frees the thumbnails; they are grabbed again once on screen.
+    void dropPreviews() {
+        m_previews.clear();
+        m_grabbedAt.clear();
+    }
+
+    // Set while the grid is not on screen.
+    void setPaused(bool paused) {
+        if (paused == m_paused) return;
+        m_paused = paused;
+        reschedule();
+    }
+
+    // Channels to grab, in priority order.
+    void setCandidates(const QStringList &urls) {
+        m_candidates = urls;
+        reschedule();
+    }
+
+signals:
+    void previewReady(const QString &url);
+
+private slots:
+    void grabNext() {
+        if (!m_enabled || m_paused || !m_currentUrl.isEmpty() || !ensurePlayer()) return;
+        qint64 now = QDateTime::currentMSecsSinceEpoch();
+        QString url;
+        for (int i = 0; i < m_candidates.size() && url.isEmpty(); ++i) {
+            QHash<QString, qint64>::const_iterator it = m_grabbedAt.constFind(m_candidates[i]);
+            if (it == m_grabbedAt.constEnd() || now - *it > PREVIEW_MAX_AGE_MS) url = m_candidates[i];
+        }
+        if (url.isEmpty()) {
+            m_nextTimer->start(PREVIEW_RECHECK_MS);
+            return;
+        }
+        m_currentUrl = url;
+        m_busyClock.start();
+        QByteArray urlBytes = url.toUtf8();
+        const char *cmd[] = {"loadfile", urlBytes.constData(), "replace", NULL};
+        mpv_command(m_mpv, cmd);
+        m_timeoutTimer->start();
+    }
+
+    void onFrameReady() {
+        if (m_currentUrl.isEmpty() || !m_renderer) return;
+        if (!m_renderer->render((QSizeF(PREVIEW_WIDTH, PREVIEW_HEIGHT) * m_dpr).toSize())) return;
+        m_renderer->reportSwap();
+        QPixmap pixmap = QPixmap::fromImage(m_renderer->image());
+        pixmap.setDevicePixelRatio(m_dpr);
+        if (m_previews.size() >= PREVIEW_CACHE_SIZE && !m_previews.contains(m_currentUrl)) evictOldest();
+        m_previews.insert(m_currentUrl, pixmap);
+        finishGrab(true);
+    }
+
+    void onMpvWakeup() {
+        while (m_mpv) {
+            mpv_event *event = mpv_wait_event(m_mpv, 0);
+            if (!event || event->event_id == MPV_EVENT_NONE) break;
+            if (event->event_id != MPV_EVENT_END_FILE) continue;
+            mpv_event_end_file *ef = static_cast<mpv_event_end_file *>(event->data);
+            if (ef && ef->reason == MPV_END_FILE_REASON_ERROR) finishGrab(false);
+        }
+    }
+
+private:
+    bool ensurePlayer() {
+        if (m_mpv) return true;
+        m_mpv = mpv_create();
+        if (!m_mpv) return false;
+        mpv_set_option_string(m_mpv, "config", "no");
+        mpv_set_option_string(m_mpv, "vo", "libmpv");
+        // Only one frame is ever wanted and it is rendered on the GUI thread,
+        // so frames are handed over as soon as they are decoded, with no
+        // waiting for a display time.
+        mpv_set_option_string(m_mpv, "untimed", "yes");
+        mpv_set_option_string(m_mpv, "video-timing-offset", "0");
+        mpv_set_option_string(m_mpv, "ao", "null");
+        mpv_set_option_string(m_mpv, "aid", "no");
+        mpv_set_option_string(m_mpv, "sid", "no");
+        mpv_set_option_string(m_mpv, "hwdec", "no");
+        mpv_set_option_string(m_mpv, "idle", "yes");
+        mpv_set_option_string(m_mpv, "input-default-bindings", "no");
+        mpv_set_option_string(m_mpv, "osc", "no");
+        mpv_set_option_string(m_mpv, "osd-level", "0");
+        mpv_set_option_string(m_mpv, "hls-bitrate", "min");
+        mpv_set_option_string(m_mpv, "vd-lavc-skipframe", "nonkey");
+        mpv_set_option_string(m_mpv, "vd-lavc-skiploopfilter", "all");
+        mpv_set_option_string(m_mpv, "vd-lavc-threads", "1");
+        mpv_set_option_string(m_mpv, "demuxer-max-bytes", "2MiB");
+        mpv_set_option_string(m_mpv, "demuxer-max-back-bytes", "0");
+        mpv_set_option_string(m_mpv, "cache-secs", "2");
+        mpv_set_option_string(m_mpv, "network-timeout", "8");
+        if (mpv_initialize(m_mpv) < 0) {
+            mpv_terminate_destroy(m_mpv);
+            m_mpv = nullptr;
+            return false;
+        }
+        m_renderer = new SoftwareRenderer(this);
+        if (!m_renderer->init(m_mpv)) {
+            shutdown();
+            return false;
+        }
+        connect(m_renderer, &SoftwareRenderer::frameReady, this, &PreviewGrabber::onFrameReady);
+        mpv_set_wakeup_callback(m_mpv, [](void *ctx) {
+            QMetaObject::invokeMethod(static_cast<PreviewGrabber *>(ctx), "onMpvWakeup", Qt::QueuedConnection);
+        }, this);
+        return true;
+    }
+
+    void shutdown() {
+        m_nextTimer->stop();
+        m_timeoutTimer->stop();
+        m_currentUrl.clear();
+        if (m_renderer) {
+            m_renderer->release();
+            delete m_renderer;
+            m_renderer = nullptr;
+        }
+        if (m_mpv) {
+            mpv_set_wakeup_callback(m_mpv, nullptr, nullptr);
+            mpv_terminate_destroy(m_mpv);
+            m_mpv = nullptr;
+        }
+    }
+
+    void reschedule() {
+        if (!m_enabled || m_paused) {
+            // An interrupted grab is retried later, not counted as done.
+            if (!m_currentUrl.isEmpty()) {
+                m_currentUrl.clear();
+                m_timeoutTimer->stop();
+                const char *cmd[] = {"stop", NULL};
+                if (m_mpv) mpv_command(m_mpv, cmd);
+            }
+            m_nextTimer->stop();
+            return;
+        }
+        if (m_currentUrl.isEmpty() && !m_nextTimer->isActive()) grabNext();
+    }
+
+    void finishGrab(bool ok) {
+        if (m_currentUrl.isEmpty()) return;
+        m_timeoutTimer->stop();
+        const char *cmd[] = {"stop", NULL};
+        mpv_command(m_mpv, cmd);
+        QString url = m_currentUrl;
+        m_currentUrl.clear();
+        m_grabbedAt.insert(url, QDateTime::currentMSecsSinceEpoch());
+        if (ok) emit previewReady(url);
+
+        // The decoder runs on at most one core while a stream is open, so
+        // wall time open bounds the CPU it used.
+        qint64 busy = m_busyClock.elapsed();
+        qint64 pause = busy * (100 - PREVIEW_CPU_PERCENT) / PREVIEW_CPU_PERCENT;
+        m_nextTimer->start(static_cast<int>(qBound<qint64>(PREVIEW_MIN_INTERVAL_MS, pause, PREVIEW_RECHECK_MS * 4)));
+    }
+
+    void evictOldest() {
+        QString oldest;
+        qint64 oldestAt = LLONG_MAX;
+        for (QHash<QString, QPixmap>::const_iterator it = m_previews.constBegin(); it != m_previews.constEnd(); ++it) {
+            qint64 at = m_grabbedAt.value(it.key());
+            if (at < oldestAt) {
+                oldestAt = at;
+                oldest = it.key();
+            }
+        }
+        m_previews.remove(oldest);
+    }
+
+    qreal m_dpr;
+    mpv_handle *m_mpv = nullptr;
+    SoftwareRenderer *m_renderer = nullptr;
+    QTimer *m_nextTimer;
+    QTimer *m_timeoutTimer;
+    QElapsedTimer m_busyClock;
+    bool m_enabled = false;
+    bool m_paused = false;
+    QStringList m_candidates;
+    QString m_currentUrl;
+    QHash<QString, QPixmap> m_previews;
+    QHash<QString, qint64> m_grabbedAt;
+};
+
+// One HLS variant as mpv exposes it: a video track carrying the variant's
+// advertised bitrate, and the audio track muxed with it if there is one.
+struct HlsVariant {
+    qint64 bitrate = 0;
+    qint64 videoId = 0;
+    qint64 audioId = 0;
+    bool selected = false;
+};
+
+// Video variants from mpv's track-list, lowest bitrate first.
+static QVector<HlsVariant> hlsVariants(const mpv_node *trackList) {
+    QVector<HlsVariant> variants;
+    if (!trackList || trackList->format != MPV_FORMAT_NODE_ARRAY) return variants;
+    QHash<qint64, qint64> audioByRate;
+    for (int i = 0; i < trackList->u.list->num; ++i) {
+        const mpv_node *track = &trackList->u.list->values[i];
+        const mpv_node *type = mpvNodeMapValue(track, "type");
+        const mpv_node *id = mpvNodeMapValue(track, "id");
+        const mpv_node *rate = mpvNodeMapValue(track, "hls-bitrate");
+        if (!type || type->format != MPV_FORMAT_STRING || !id || id->format != MPV_FORMAT_INT64) continue;
+        if (!rate || rate->format != MPV_FORMAT_INT64 || rate->u.int64 <= 0) continue;
+        if (strcmp(type->u.string, "audio") == 0) {
+            audioByRate.insert(rate->u.int64, id->u.int64);
+        } else if (strcmp(type->u.string, "video") == 0) {
+            const mpv_node *selected = mpvNodeMapValue(track, "selected");
+            HlsVariant v;
+            v.bitrate = rate->u.int64;
+            v.videoId = id->u.int64;
+            v.selected = selected && selected->format == MPV_FORMAT_FLAG && selected->u.flag;
+            variants.append(v);
+        }
+    }
+    for (HlsVariant &v : variants) v.audioId = audioByRate.value(v.bitrate);
+    std::sort(variants.begin(), variants.end(),
+              [](const HlsVariant &a, const HlsVariant &b) { return a.bitrate < b.bitrate; });
+    return variants;
+}
+
+class MosaicTile : public VideoWidget {
+    Q_OBJECT
+public:
+    // Decode cost drops with each level: only the focused tile has audio,
+    // background tiles skip the loop filter and take the lowest HLS variant,
+    // and the budget can push them further down to keyframes only. Tiles
+    // always render through the software render API into the widget, so a
+    // grid does not create one native video window per tile.
+    enum Level { Focused, Background, Reduced, KeyframesOnly };
+
+    explicit MosaicTile(QWidget *parent = nullptr) : VideoWidget(parent) {
+        setMinimumSize(96, 54);
+    }
+
+    ~MosaicTile() override {
+        if (mpv_handle *mpv = takeHandle()) mpv_terminate_destroy(mpv);
+    }
+
+    // Frees the renderer and hands over the mpv handle, so the caller can
+    // destroy it without holding up the GUI thread.
+    mpv_handle *takeHandle() {
+        if (m_renderer) m_renderer->release();
+        mpv_handle *mpv = m_mpv;
+        if (mpv) mpv_set_wakeup_callback(mpv, nullptr, nullptr);
+        m_mpv = nullptr;
+        return mpv;
+    }
+
+    bool init(qreal renderScale) {
+        m_mpv = mpv_create();
+        if (!m_mpv) return false;
+
+        mpv_set_option_string(m_mpv, "hwdec", "no");
+        mpv_set_option_string(m_mpv, "vo", "libmpv");
+        mpv_set_option_string(m_mpv, "video-timing-offset", "0");
+        mpv_set_option_string(m_mpv, "keep-open", "yes");
+        mpv_set_option_string(m_mpv, "idle", "yes");
+        mpv_set_option_string(m_mpv, "input-default-bindings", "no");
+        mpv_set_option_string(m_mpv, "input-vo-keyboard", "no");
+        mpv_set_option_string(m_mpv, "osc", "no");
+        mpv_set_option_string(m_mpv, "osd-level", "0");
+        mpv_set_option_string(m_mpv, "cache", "yes");
+        mpv_set_option_string(m_mpv, "demuxer-max-bytes", "8MiB");
+        mpv_set_option_string(m_mpv, "demuxer-max-back-bytes", "1MiB");
+        mpv_set_option_string(m_mpv, "cache-secs", "5");
+        mpv_set_option_string(m_mpv, "network-timeout", "15");
+        mpv_set_option_string(m_mpv, "vd-lavc-threads", "2");
+
+        if (mpv_initialize(m_mpv) < 0) {
+            mpv_terminate_destroy(m_mpv);
+            m_mpv = nullptr;
+            return false;
+        }
+        m_renderer = new SoftwareRenderer(this);
+        if (!m_renderer->init(m_mpv)) {
+            delete m_renderer;
+            m_renderer = nullptr;
+            mpv_terminate_destroy(m_mpv);
+            m_mpv = nullptr;
+            return false;
+        }
+        setSoftwareRenderer(m_renderer, renderScale);
+        mpv_set_wakeup_callback(m_mpv, [](void *ctx) {
+            QMetaObject::invokeMethod(static_cast<MosaicTile *>(ctx), "onMpvWakeup", Qt::QueuedConnection);
+        }, this);
+        applyLevel(false);
+        return true;
+    }
+
+    void play(const QString &url, const QString &name) {
+        m_streamUrl = url;
+        m_channelName = name;
+        if (!m_mpv || url.isEmpty()) return;
+        QByteArray urlBytes = url.toUtf8();
+        const char *cmd[] = {"loadfile", urlBytes.constData(), "replace", NULL};
+        mpv_command(m_mpv, cmd);
+    }
+
+    void setLevel(Level level) {
+        if (level == m_level) return;
+        m_level = level;
+        applyLevel(true);
+    }
+
+    void setVolume(int volume) {
+        if (m_mpv) mpv_set_property_string(m_mpv, "volume", QString::number(volume).toUtf8().constData());
+    }
+
+    void setMuted(bool muted) {
+        if (m_mpv) mpv_set_property_string(m_mpv, "mute", muted ? "yes" : "no");
+    }
+
+    Level level() const { return m_level; }
+    QString streamUrl() const { return m_streamUrl; }
+    QString channelName() const { return m_channelName; }
+
+signals:
+    void clicked(MosaicTile *tile);
+
+protected:
+    void mousePressEvent(QMouseEvent *event) override {
+        emit clicked(this);
+        VideoWidget::mousePressEvent(event);
+    }
+
+private slots:
+    void onMpvWakeup() {
+        while (m_mpv) {
+            mpv_event *event = mpv_wait_event(m_mpv, 0);
+            if (!event || event->event_id == MPV_EVENT_NONE) break;
+        }
+    }
+
+private:
+    void applyLevel(bool reloadDecoder) {
+        if (!m_mpv) return;
+        const char *skipLoop = "default";
+        const char *skipFrame = "default";
+        switch (m_level) {
+            case Focused:
+                break;
+            case Background:
+                skipLoop = "all";
+                break;
+            case Reduced:
+                skipLoop = "all";
+                skipFrame = "nonref";
+                break;
+            case KeyframesOnly:
+                skipLoop = "all";
+                skipFrame = "nonkey";
+                break;
+        }
+        bool focused = m_level == Focused;
+        mpv_set_property_string(m_mpv, "framedrop", focused ? "vo" : "decoder+vo");
+        mpv_set_property_string(m_mpv, "hls-bitrate", focused ? "max" : "min");
+        mpv_set_property_string(m_mpv, "vd-lavc-skiploopfilter", skipLoop);
+        mpv_set_property_string(m_mpv, "vd-lavc-skipframe", skipFrame);
+        if (!reloadDecoder || m_streamUrl.isEmpty()) {
+            mpv_set_property_string(m_mpv, "aid", focused ? "auto" : "no");
+            return;
+        }
+
+        // hls-bitrate is only read when a stream is opened, so a stream that
+        // is already playing is moved to the variant it would have picked.
+        QByteArray vid = "auto";
+        QByteArray aid = focused ? "auto" : "no";
+        QVector<HlsVariant> variants = currentVariants();
+        if (variants.size() > 1) {
+            const HlsVariant &v = focused ? variants.last() : variants.first();
+            vid = QByteArray::number(v.videoId);
+            if (focused && v.audioId > 0) aid = QByteArray::number(v.audioId);
+        }
+        mpv_set_property_string(m_mpv, "aid", aid.constData());
+        // Decoder options are only read when the decoder is created.
+        mpv_set_property_string(m_mpv, "vid", "no");
+        mpv_set_property_string(m_mpv, "vid", vid.constData());
+    }
+
+    QVector<HlsVariant> currentVariants() const {
+        mpv_node node;
+        if (!m_mpv || mpv_get_property(m_mpv, "track-list", MPV_FORMAT_NODE, &node) < 0) return QVector<HlsVariant>();
+        QVector<HlsVariant> variants = hlsVariants(&node);
+        mpv_free_node_contents(&node);
+        return variants;
+    }
+
+    mpv_handle *m_mpv = nullptr;
+    SoftwareRenderer *m_renderer = nullptr;
+    Level m_level = Background;
+    QString m_streamUrl;
+    QString m_channelName;
+};
+
+// mpv_terminate_destroy waits for the player core to shut down, which for a
+// full grid adds up to a visible stall, so tile handles are destroyed here.
+class MpvReaper : public QObject {
+    Q_OBJECT
+public slots:
+    void destroy(void *handle) { mpv_terminate_destroy(static_cast<mpv_handle *>(handle)); }
+    void drain() {}
+};
+
+class MosaicView : public QWidget {
+    Q_OBJECT
+public:
+    explicit MosaicView(QWidget *parent = nullptr) : QWidget(parent) {
+        m_layout = new QGridLayout(this);
+        m_layout->setContentsMargins(2, 2, 2, 2);
+        m_layout->setSpacing(2);
+
+        m_budgetTimer = new QTimer(this);
+        m_budgetTimer->setInterval(MOSAIC_BUDGET_INTERVAL_MS);
+        connect(m_budgetTimer, &QTimer::timeout, this, &MosaicView::checkBudget);
+
+        m_reaperThread = new QThread(this);
+        m_reaper = new MpvReaper;
+        m_reaper->moveToThread(m_reaperThread);
+        connect(m_reaperThread, &QThread::finished, m_reaper, &QObject::deleteLater);
+        m_reaperThread->start();
+    }
+
+    ~MosaicView() override {
+        stop();
+        // Handles still queued must be gone before the process tears down.
+        QMetaObject::invokeMethod(m_reaper, "drain", Qt::BlockingQueuedConnection);
+        m_reaperThread->quit();
+        m_reaperThread->wait();
+    }
+
+    void setRenderScale(qreal scale) { m_renderScale = scale; }
+
+    void start(int gridSize, const QVector<Channel> &channels, int volume, bool muted) {
+        stop();
+        m_gridSize = gridSize;
+        for (int i = 0; i < gridSize * gridSize && i < channels.size(); ++i) {
+            MosaicTile *tile = new MosaicTile(this);
+            m_layout->addWidget(tile, i / gridSize, i % gridSize);
+            if (!tile->init(m_renderScale)) {
+                delete tile;
+                emit statusMessage("Failed to create mpv instance for mosaic tile.");
+                break;
+            }
+            tile->setVolume(volume);
+            tile->setMuted(muted);
+            connect(tile, &MosaicTile::clicked, this, &MosaicView::focusTile);
+            connect(tile, &VideoWidget::doubleClicked, this, [this, tile]() {
+                emit tileActivated(tile->streamUrl(), tile->channelName());
+            });
+            tile->play(channels[i].streamUrl, channels[i].name);
+            m_tiles.append(tile);
+        }
+        if (!m_tiles.isEmpty()) focusTile(m_tiles.first());
+        m_lastCpuMs = processCpuMs();
+        m_sampleClock.start();
+        m_budgetTimer->start();
+    }
+
+    void stop() {
+        m_budgetTimer->stop();
+        m_focused = nullptr;
+        for (int i = 0; i < m_tiles.size(); ++i) {
+            if (mpv_handle *mpv = m_tiles[i]->takeHandle()) {
+                QMetaObject::invokeMethod(m_reaper, "destroy", Qt::QueuedConnection, Q_ARG(void *, mpv));
+            }
+        }
+        qDeleteAll(m_tiles);
+        m_tiles.clear();
+        m_gridSize = 0;
+    }
+
+    void cycleFocus(int direction) {
+        if (m_tiles.isEmpty()) return;
+        int i = m_tiles.indexOf(m_focused) + direction;
+        if (i < 0) i = m_tiles.size() - 1;
+        if (i >= m_tiles.size()) i = 0;
+        focusTile(m_tiles[i]);
+    }
+
+    void setVolume(int volume) {
+        for (int i = 0; i < m_tiles.size(); ++i) m_tiles[i]->setVolume(volume);
+    }
+
+    void setMuted(bool muted) {
+        for (int i = 0; i < m_tiles.size(); ++i) m_tiles[i]->setMuted(muted);
+    }
+
+    int gridSize() const { return m_gridSize; }
+    bool isActive() const { return m_gridSize > 0; }
+    MosaicTile *focusedTile() const { return m_focused; }
+
+signals:
+    void tileActivated(const QString &url, const QString &name);
+    void statusMessage(const QString &message);
+
+protected:
+    void paintEvent(QPaintEvent *) override {
+        QPainter p(this);
+        p.fillRect(rect(), QColor(15, 15, 26));
+        if (m_focused) {
+            p.fillRect(m_focused->geometry().adjusted(-2, -2, 2, 2), QColor(99, 102, 241));
+        }
+    }
+
+private:
+    void focusTile(MosaicTile *tile) {
+        if (tile == m_focused) return;
+        if (m_focused) m_focused->setLevel(MosaicTile::Background);
+        m_focused = tile;
+        tile->setLevel(MosaicTile::Focused);
+        update();
+        emit statusMessage("Mosaic: " + tile->channelName());
+    }
+
+    // Downgrades one non-focused tile per sample while the process is over
+    // its CPU or memory budget, and upgrades one back once usage has
+    // dropped well below it.
+    void checkBudget() {
+        qint64 cpuMs = processCpuMs();
+        qint64 wallMs = m_sampleClock.restart();
+        int cores = qMax(1, QThread::idealThreadCount());
+        int cpuPercent = wallMs > 0 ? static_cast<int>((cpuMs - m_lastCpuMs) * 100 / (wallMs * cores)) : 0;
+        m_lastCpuMs = cpuMs;
+        qint64 rss = processRssBytes();
+
+        if (cpuPercent > MOSAIC_CPU_BUDGET_PERCENT || rss > MOSAIC_MEMORY_BUDGET) {
+            MosaicTile *victim = nullptr;
+            for (int i = 0; i < m_tiles.size(); ++i) {
+                MosaicTile *t = m_tiles[i];
+                if (t == m_focused || t->level() == MosaicTile::KeyframesOnly) continue;
+                if (!victim || t->level() < victim->level()) victim = t;
+            }
+            if (victim) {
+                victim->setLevel(static_cast<MosaicTile::Level>(victim->level() + 1));
+                emit statusMessage(QString("Mosaic over budget (CPU %1%, %2 MiB): reduced %3")
+                                       .arg(cpuPercent).arg(rss / (1024 * 1024)).arg(victim->channelName()));
+            }
+        } else if (cpuPercent < MOSAIC_CPU_RELEASE_PERCENT && rss < MOSAIC_MEMORY_BUDGET * 3 / 4) {
+            MosaicTile *lucky = nullptr;
+            for (int i = 0; i < m_tiles.size(); ++i) {
+                MosaicTile *t = m_tiles[i];
+                if (t == m_focused || t->level() <= MosaicTile::Background) continue;
+                if (!lucky || t->level() > lucky->level()) lucky = t;
+            }
+            if (lucky) lucky->setLevel(static_cast<MosaicTile::Level>(lucky->level() - 1));
+        }
+    }
+
+    QGridLayout *m_layout;
+    QTimer *m_budgetTimer;
+    QThread *m_reaperThread;
+    MpvReaper *m_reaper;
+    QVector<MosaicTile *> m_tiles;
+    MosaicTile *m_focused = nullptr;
+    QElapsedTimer m_sampleClock;
+    qint64 m_lastCpuMs = 0;
+    int m_gridSize = 0;
+    qreal m_renderScale = 1.0;
+};
+
+// Loopback HTTP relay that every local consumer (player, time-shift, recorder)
+// goes through, so an upstream manifest or segment is fetched once no matter
+// how many of them want it. Manifests are cached briefly and rewritten to
+// point back at the relay; segments go into a bounded LRU cache; continuous
+// bodies with no Content-Length are fanned out to all attached clients.
+// Bodies over RELAY_MAX_BUFFERED_BYTES and ranged requests are piped through
+// per client with their status and range headers, so files stay seekable.
+// Lives on its own thread; relayUrl() may be called from anywhere.
+// prewarm() readies a stream's host, and for HLS its manifest, ahead of a
+// likely zap.
+class StreamRelay : public QObject {
+    Q_OBJECT
+public:
+    explicit StreamRelay(QObject *parent = nullptr) : QObject(parent) {}
+
+    QString relayUrl(const QString &upstream) const {
+        int port = m_port.loadAcquire();
+        QUrl url(upstream);
+        QString scheme = url.scheme().toLower();
+        if (port == 0 || (scheme != "http" && scheme != "https")) return upstream;
+        QString name = url.fileName();
+        if (name.isEmpty()) name = "stream";
+        QByteArray key = upstream.toUtf8().toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+        return QString("http://127.0.0.1:%1/r/%2/%3")
+            .arg(port)
+            .arg(QString::fromLatin1(key), QString::fromLatin1(QUrl::toPercentEncoding(name)));
+    }
+
+    // Every URI in a playlist, including those inside tag attributes such as
+    // EXT-X-KEY and EXT-X-MAP, is resolved and pointed back at the relay.
+    QByteArray rewriteManifest(const QUrl &base, const QByteArray &body) const {
+        static const QRegularExpression reUri("URI=\"([^\"]+)\"");
+        QByteArray out;
+        out.reserve(body.size() * 2);
+        const QList<QByteArray> lines = body.split('\n');
+        for (const QByteArray &raw : lines) {
+            QByteArray line = raw.trimmed();
+            if (line.startsWith('#')) {
+                QString tag = QString::fromUtf8(line);
+                QRegularExpressionMatch m = reUri.match(tag);
+                if (m.hasMatch()) {
+                    QString target = relayUrl(base.resolved(QUrl(m.captured(1))).toString());
+                    tag.replace(m.capturedStart(1), m.capturedLength(1), target);
+                }
+                out += tag.toUtf8();
+            } else if (!line.isEmpty()) {
+                out += relayUrl(base.resolved(QUrl(QString::fromUtf8(line))).toString()).toUtf8();
+            }
+            out += '\n';
+        }
+        return out;
+    }
+
+public slots:
+    void start() {
+        m_clock.start();
+        m_nam = new QNetworkAccessManager(this);
+        m_server = new QTcpServer(this);
+        connect(m_server, &QTcpServer::newConnection, this, &StreamRelay::onNewConnection);
+        if (m_server->listen(QHostAddress::LocalHost, 0)) m_port.storeRelease(m_server->serverPort());
+    }
+
+    // Resolves the stream host and opens a connection that the relay's next
+    // fetch to it reuses; an HLS manifest is fetched into the cache instead,
+    // which does both and saves the first round trip as well. RTSP and RTMP
+    // are opened by mpv itself, so for those only the name lookup is done.
+    // At most PREWARM_PER_SECOND warm-ups run per second, and no more than
+    // PREWARM_MAX_IDLE_HOSTS hosts are held warm without being used.
+    void prewarm(const QString &upstream) {
+        QUrl url(upstream);
+        QString scheme = url.scheme().toLower();
+        if (url.host().isEmpty()) return;
+        qint64 now = m_clock.elapsed();
+        while (!m_prewarmTimes.isEmpty() && now - m_prewarmTimes.head() >= 1000) m_prewarmTimes.dequeue();
+        if (m_prewarmTimes.size() >= PREWARM_PER_SECOND) return;
+        for (auto it = m_warmHosts.begin(); it != m_warmHosts.end();) {
+            if (now - it.value() > PREWARM_IDLE_MS) it = m_warmHosts.erase(it);
+            else ++it;
+        }
+
+        bool http = scheme == "http" || scheme == "https";
+        QString path = url.path().toLower();
+        auto cached = m_entries.constFind(upstream);
+        bool fetchManifest = http && (path.endsWith(".m3u8") || path.endsWith(".m3u")) &&
+                             (cached == m_entries.constEnd() ||
+                              (!cached->reply && now - cached->fetchedAt >= RELAY_MANIFEST_TTL_MS));
+        QString key = hostKey(url);
+        bool warmHost = !m_warmHosts.contains(key) && m_warmHosts.size() < PREWARM_MAX_IDLE_HOSTS;
+        if (!fetchManifest && !warmHost) return;
+        m_prewarmTimes.enqueue(now);
+        if (warmHost) m_warmHosts.insert(key, now);
+
+        if (fetchManifest) {
+            Entry &e = m_entries[upstream];
+            e.prefetched = true;
+            e.lastUsed = now;
+            fetch(upstream);
+        } else if (scheme == "https") {
+#ifndef QT_NO_SSL
+            m_nam->connectToHostEncrypted(url.host(), url.port(443));
+#endif
+        } else if (scheme == "http") {
+            m_nam->connectToHost(url.host(), url.port(80));
+        } else {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
+            QHostInfo::lookupHost(url.host(), this, [](const QHostInfo &) {});
+#endif
+        }
+    }
+
+    void stop() {
+        m_port.storeRelease(0);
+        if (m_server) m_server->close();
+        QList<QNetworkReply *> replies;
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->reply) replies.append(it->reply);
+        }
+        m_entries.clear();
+        m_cachedBytes = 0;
+        for (QNetworkReply *reply : replies) reply->abort();
+    }
+
+signals:
+    // An upstream segment arrived in full; ms runs from the request.
+    void transferred(qint64 bytes, qint64 ms);
+
+private slots:
+    void onNewConnection() {
+        while (QTcpSocket *sock = m_server->nextPendingConnection()) {
+            connect(sock, &QTcpSocket::disconnected, sock, &QObject::deleteLater);
+            connect(sock, &QTcpSocket::readyRead, this, [this, sock]() { onRequestData(sock); });
+            connect(sock, &QObject::destroyed, this, [this, sock]() { m_pending.remove(sock); });
+        }
+    }
+
+private:
+    struct Entry {
+        QNetworkReply *reply = nullptr;
+        QByteArray data;
+        QByteArray contentType;
+        QList<QPointer<QTcpSocket>> waiters;
+        QList<QPointer<QTcpSocket>> subscribers;
+        qint64 fetchedAt = 0;
+        qint64 lastUsed = 0;
+        int retries = 0;
+        bool complete = false;
+        bool live = false;
+        bool manifest = false;
+        bool prefetched = false;
+        bool maybeLive = false;  // unsized 200 whose first bytes are not in yet
+    };
+
+    void onRequestData(QTcpSocket *sock) {
+        QByteArray &buf = m_pending[sock];
+        buf += sock->readAll();
+        int end = buf.indexOf("\r\n\r\n");
+        if (end < 0) {
+            if (buf.size() > 16 * 1024) sock->abort();
+            return;
+        }
+        QList<QByteArray> headerLines = buf.left(end).split('\n');
+        QList<QByteArray> requestLine = headerLines.first().trimmed().split(' ');
+        QByteArray range;
+        for (int i = 1; i < headerLines.size(); ++i) {
+            QByteArray line = headerLines[i].trimmed();
+            if (line.toLower().startsWith("range:")) range = line.mid(6).trimmed();
+        }
+        m_pending.remove(sock);
+        disconnect(sock, &QTcpSocket::readyRead, this, nullptr);
+
+        QByteArray path = requestLine.size() >= 2 ? requestLine[1] : QByteArray();
+        QList<QByteArray> parts = path.split('/');
+        if (requestLine[0] != "GET" || parts.size() < 3 || parts[1] != "r") {
+            respond(sock, 404, "text/plain", "Not found");
+            return;
+        }
+        QString upstream = QString::fromUtf8(QByteArray::fromBase64(parts[2], QByteArray::Base64UrlEncoding));
+        if (upstream.isEmpty()) {
+            respond(sock, 404, "text/plain", "Not found");
+            return;
+        }
+        // mpv asks for "bytes=0-" on every first request; anything else is a
+        // seek and gets its own upstream request.
+        if (!range.isEmpty() && range != "bytes=0-") {
+            pipe(sock, upstream, range);
+            return;
+        }
+        serve(sock, upstream);
+    }
+
+    void serve(QTcpSocket *sock, const QString &upstream) {
+        if (!m_warmHosts.isEmpty()) m_warmHosts.remove(hostKey(QUrl(upstream)));
+        Entry &e = m_entries[upstream];
+        e.lastUsed = m_clock.elapsed();
+        if (e.live) {
+            attach(sock, e);
+            return;
+        }
+        // A prefetched manifest is older by the time the zap arrives; it is
+        // accepted a little longer, once, since mpv reloads it anyway.
+        int ttl = e.prefetched ? PREWARM_MANIFEST_TTL_MS : RELAY_MANIFEST_TTL_MS;
+        e.prefetched = false;
+        if (e.complete && (!e.manifest || e.lastUsed - e.fetchedAt < ttl)) {
+            respond(sock, 200, e.contentType, e.data);
+            return;
+        }
+        e.waiters.append(sock);
+        if (!e.reply) fetch(upstream);
+    }
+
+    void fetch(const QString &upstream) {
+        QNetworkReply *reply = m_nam->get(NetworkLayer::request(QUrl(upstream), NET_STALL_TIMEOUT_MS));
+        m_entries[upstream].reply = reply;
+        qint64 startedAt = m_clock.elapsed();
+
+        connect(reply, &QNetworkReply::metaDataChanged, this, [this, upstream, reply]() {
+            auto it = m_entries.find(upstream);
+            if (it == m_entries.end() || it->reply != reply || it->live) return;
+            int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            QByteArray type = reply->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+            QString path = reply->url().path().toLower();
+            if (status != 200 || type.contains("mpegurl") || path.endsWith(".m3u8") || path.endsWith(".m3u")) return;
+            QVariant length = reply->header(QNetworkRequest::ContentLengthHeader);
+            if (length.isValid()) {
+                if (length.toLongLong() <= RELAY_MAX_BUFFERED_BYTES) return;
+                // Too large to hold before serving, e.g. a VOD file or a
+                // progressive download: the first client takes this reply
+                // over as a pipe and any others get their own.
+                QList<QPointer<QTcpSocket>> waiters = it->waiters;
+                m_entries.erase(it);
+                bool handedOver = false;
+                for (const QPointer<QTcpSocket> &sock : waiters) {
+                    if (!sock) continue;
+                    pipe(sock, upstream, QByteArray(), handedOver ? nullptr : reply);
+                    handedOver = true;
+                }
+                if (!handedOver) reply->abort();
+                return;
+            }
+            // Playlists also come chunked from scripts and extensionless
+            // URLs; the body decides once its first bytes arrive.
+            it->maybeLive = true;
+            it->contentType = type.isEmpty() ? QByteArray("video/mp2t") : type;
+        });
+        connect(reply, &QNetworkReply::readyRead, this, [this, upstream, reply]() {
+            auto it = m_entries.find(upstream);
+            if (it == m_entries.end() || it->reply != reply) return;
+            if (it->maybeLive) {
+                static const QByteArray playlistMagic("#EXTM3U");
+                if (reply->bytesAvailable() < playlistMagic.size()) return;
+                it->maybeLive = false;
+                if (reply->peek(playlistMagic.size()) == playlistMagic) return;
+                it->live = true;
+                for (const QPointer<QTcpSocket> &sock : it->waiters) {
+                    if (sock) attach(sock, *it);
+                }
+                it->waiters.clear();
+                // A prefetch that turned out to be a continuous body has
+                // nobody to feed; aborting finishes and erases the entry.
+                if (it->subscribers.isEmpty()) {
+                    reply->abort();
+                    return;
+                }
+            }
+            if (!it->live) return;
+            QByteArray chunk = reply->readAll();
+            QList<QPointer<QTcpSocket>> subscribers = it->subscribers;
+            for (const QPointer<QTcpSocket> &sock : subscribers) {
+                if (!sock) continue;
+                // A client that cannot keep up is cut off rather than letting
+                // its backlog grow without bound; it will reconnect.
+                if (sock->bytesToWrite() > RELAY_MAX_CLIENT_BACKLOG) sock->abort();
+                else sock->write(chunk);
+            }
+        });
+        connect(reply, &QNetworkReply::finished, this, [this, upstream, reply, startedAt]() {
+            reply->deleteLater();
+            auto it = m_entries.find(upstream);
+            if (it == m_entries.end() || it->reply != reply) return;
+            it->reply = nullptr;
+
+            if (it->live) {
+                for (const QPointer<QTcpSocket> &sock : it->subscribers) {
+                    if (sock) sock->disconnectFromHost();
+                }
+                m_entries.erase(it);
+                return;
+            }
+
+            if (reply->error() != QNetworkReply::NoError) {
+                if (it->retries++ < RELAY_MAX_RETRIES && !it->waiters.isEmpty()) {
+                    QTimer::singleShot(RELAY_RETRY_DELAY_MS * it->retries, this, [this, upstream]() {
+                        auto again = m_entries.find(upstream);
+                        if (again != m_entries.end() && !again->reply) fetch(upstream);
+                    });
+                    return;
+                }
+                QByteArray message = reply->errorString().toUtf8();
+                for (const QPointer<QTcpSocket> &sock : it->waiters) {
+                    if (sock) respond(sock, 502, "text/plain", message);
+                }
+                it->waiters.clear();
+                it->retries = 0;
+                if (!it->complete) m_entries.erase(it);
+                return;
+            }
+
+            QByteArray body = reply->readAll();
+            QByteArray type = reply->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+            it->manifest = body.startsWith("#EXTM3U");
+            if (it->manifest) {
+                body = rewriteManifest(reply->url(), body);
+                type = "application/vnd.apple.mpegurl";
+            } else {
+                emit transferred(body.size(), m_clock.elapsed() - startedAt);
+            }
+            m_cachedBytes += body.size() - it->data.size();
+            it->data = body;
+            it->contentType = type.isEmpty() ? QByteArray("application/octet-stream") : type;
+            it->complete = true;
+            it->retries = 0;
+            it->fetchedAt = m_clock.elapsed();
+            for (const QPointer<QTcpSocket> &sock : it->waiters) {
+                if (sock) respond(sock, 200, it->contentType, it->data);
+            }
+            it->waiters.clear();
+            evict();
+        });
+    }
+
+    // Streams one client's own upstream request through as it arrives, for
+    // ranged requests and for bodies too large to buffer. The upstream status
+    // and length and range headers are passed on so the client can seek, and
+    // upstream is only read as fast as the client takes the data.
+    void pipe(QTcpSocket *sock, const QString &upstream, const QByteArray &range, QNetworkReply *reply = nullptr) {
+        if (!reply) {
+            QNetworkRequest req = NetworkLayer::request(QUrl(upstream), NET_STALL_TIMEOUT_MS);
+            // Byte offsets refer to the stored body, so nothing may be
+            // decompressed on the way through.
+            req.setRawHeader("Accept-Encoding", "identity");
+            if (!range.isEmpty()) req.setRawHeader("Range", range);
+            reply = m_nam->get(req);
+        }
+        reply->setReadBufferSize(RELAY_PIPE_BUFFER_BYTES);
+        QPointer<QTcpSocket> client(sock);
+
+        auto sendHeaders = [reply, client]() {
+            if (!client || reply->property("relayHeadersSent").toBool()) return;
+            int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            if (status == 0) return;
+            reply->setProperty("relayHeadersSent", true);
+            QByteArray reason = reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toByteArray();
+            QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + " " + reason + "\r\n";
+            QByteArray type = reply->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+            head += "Content-Type: " + (type.isEmpty() ? QByteArray("application/octet-stream") : type) + "\r\n";
+            static const char *const passed[] = {"Content-Length", "Content-Range", "Accept-Ranges"};
+            for (const char *name : passed) {
+                if (reply->hasRawHeader(name)) head += QByteArray(name) + ": " + reply->rawHeader(name) + "\r\n";
+            }
+            head += "Cache-Control: no-cache\r\nConnection: close\r\n\r\n";
+            client->write(head);
+        };
+        auto forward = [reply, client, sendHeaders]() {
+            if (!client) return;
+            sendHeaders();
+            if (!reply->property("relayHeadersSent").toBool()) return;
+            while (reply->bytesAvailable() > 0 && client->bytesToWrite() < RELAY_PIPE_BUFFER_BYTES) {
+                client->write(reply->read(RELAY_PIPE_BUFFER_BYTES));
+            }
+        };
+
+        connect(reply, &QNetworkReply::metaDataChanged, this, sendHeaders);
+        connect(reply, &QNetworkReply::readyRead, this, forward);
+        connect(sock, &QTcpSocket::bytesWritten, reply, forward);
+        connect(sock, &QTcpSocket::disconnected, reply, [reply]() {
+            if (reply->isRunning()) reply->abort();
+        });
+        connect(reply, &QNetworkReply::finished, this, [this, reply, client, forward]() {
+            reply->deleteLater();
+            if (!client) return;
+            if (!reply->property("relayHeadersSent").toBool() && reply->error() != QNetworkReply::NoError &&
+                reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 0) {
+                respond(client, 502, "text/plain", reply->errorString().toUtf8());
+                return;
+            }
+            // Whatever the read buffer still holds is at most
+            // RELAY_PIPE_BUFFER_BYTES; the socket flushes it before closing.
+            forward();
+            if (reply->bytesAvailable() > 0) client->write(reply->readAll());
+            client->disconnectFromHost();
+        });
+        if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid()) forward();
+    }
+
+    void attach(QTcpSocket *sock, Entry &e) {
+        sock->write("HTTP/1.1 200 OK\r\nContent-Type: " + e.contentType +
+                    "\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n");
+        e.subscribers.append(sock);
+        connect(sock, &QTcpSocket::disconnected, this, [this, sock]() { detach(sock); });
+    }
+
+    void detach(QTcpSocket *sock) {
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (!it->live || !it->subscribers.contains(sock)) continue;
+            it->subscribers.removeAll(sock);
+            it->subscribers.removeAll(QPointer<QTcpSocket>());
+            if (it->subscribers.isEmpty() && it->reply) it->reply->abort();
+            return;
+        }
+    }
+
+    void respond(QTcpSocket *sock, int code, const QByteArray &type, const QByteArray &body) {
+        QByteArray reason = code == 200 ? "OK" : code == 404 ? "Not Found" : "Bad Gateway";
+        sock->write("HTTP/1.1 " + QByteArray::number(code) + " " + reason +
+                    "\r\nContent-Type: " + type +
+                    "\r\nContent-Length: " + QByteArray::number(body.size()) +
+                    "\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n");
+        sock->write(body);
+        sock->disconnectFromHost();
+    }
+
+    // Least-recently-used completed entries go first. Manifests are small and
+    // expire on their own, so in practice this is segment eviction.
+    void evict() {
+        qint64 now = m_clock.elapsed();
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            bool stale = it->complete && it->manifest && !it->reply && it->waiters.isEmpty() &&
+                         now - it->lastUsed > RELAY_MANIFEST_TTL_MS * 30;
+            if (stale) {
+                m_cachedBytes -= it->data.size();
+                it = m_entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        while (m_cachedBytes > RELAY_CACHE_BYTES) {
+            auto victim = m_entries.end();
+            for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+                if (!it->complete || it->reply || !it->waiters.isEmpty()) continue;
+                if (victim == m_entries.end() || it->lastUsed < victim->lastUsed) victim = it;
+            }
+            if (victim == m_entries.end()) break;
+            m_cachedBytes -= victim->data.size();
+            m_entries.erase(victim);
+        }
+    }
+
+    static QString hostKey(const QUrl &url) {
+        QString scheme = url.scheme().toLower();
+        return scheme + "://" + url.host().toLower() + ":" + QString::number(url.port(scheme == "https" ? 443 : 80));
+    }
+
+    QTcpServer *m_server = nullptr;
+    QNetworkAccessManager *m_nam = nullptr;
+    QAtomicInt m_port;
+    QHash<QString, Entry> m_entries;
+    QHash<QTcpSocket *, QByteArray> m_pending;
+    qint64 m_cachedBytes = 0;
+    QElapsedTimer m_clock;
+    QHash<QString, qint64> m_warmHosts;  // host key -> when it was warmed
+    QQueue<qint64> m_prewarmTimes;
+};
+
+// Pulls a live stream as a byte sequence on whatever thread it lives in.
+// Continuous HTTP bodies (MPEG-TS and the like) are passed through as they
+// arrive; HLS playlists are followed, joining near the live edge and
+// emitting each new segment in order.
+class StreamFetcher : public QObject {
+    Q_OBJECT
+public:
+    explicit StreamFetcher(const QString &url, QObject *parent = nullptr) : QObject(parent), m_url(url) {}
+
+signals:
+    void dataReady(const QByteArray &data);
+    void failed(const QString &error);
+
+public slots:
+    void start() {
+        m_nam = new QNetworkAccessManager(this);
+        m_timer = new QTimer(this);
+        m_timer->setSingleShot(true);
+        connect(m_timer, &QTimer::timeout, this, [this]() {
+            if (m_mediaUrl.isValid()) pollMedia();
+            else fetchRoot();
+        });
+        fetchRoot();
+    }
+
+    void stop() {
+        m_stopped = true;
+        if (m_timer) m_timer->stop();
+        if (m_reply) m_reply->abort();
+        if (m_segmentReply) m_segmentReply->abort();
+    }
+
+private:
+    enum Mode { Detecting, Continuous, Playlist };
+
+    QNetworkReply *get(const QUrl &url) {
+        return m_nam->get(NetworkLayer::request(url, NET_STALL_TIMEOUT_MS));
+    }
+
+    void fetchRoot() {
+        m_mode = Detecting;
+        QNetworkReply *reply = get(QUrl(m_url));
+        m_reply = reply;
+        connect(reply, &QNetworkReply::readyRead, this, [this, reply]() {
+            if (m_mode == Detecting) {
+                if (reply->bytesAvailable() < 7) return;
+                m_mode = reply->peek(7) == "#EXTM3U" ? Playlist : Continuous;
+            }
+            if (m_mode == Continuous) deliver(reply->readAll());
+        });
+        connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+            m_reply = nullptr;
+            reply->deleteLater();
+            if (m_stopped) return;
+            if (reply->error() != QNetworkReply::NoError) {
+                retryLater(reply->errorString());
+                return;
+            }
+            QByteArray body = reply->readAll();
+            if (m_mode != Continuous && body.startsWith("#EXTM3U")) {
+                handlePlaylist(reply->url(), body);
+                return;
+            }
+            deliver(body);
+            retryLater("Stream ended");
+        });
+    }
+
+    void handlePlaylist(const QUrl &base, const QByteArray &body) {
+        QList<QByteArray> lines = body.split('\n');
+        for (int i = 0; i < lines.size(); ++i) {
+            if (!lines[i].startsWith("#EXT-X-STREAM-INF")) continue;
+            for (int j = i + 1; j < lines.size(); ++j) {
+                QByteArray uri = lines[j].trimmed();
+                if (uri.isEmpty() || uri.startsWith('#')) continue;
+                m_mediaUrl = base.resolved(QUrl(QString::fromUtf8(uri)));
+                pollMedia();
+                return;
+            }
+        }
+        m_mediaUrl = base;
+        parseMedia(base, body);
+    }
+
+    void pollMedia() {
+        QNetworkReply *reply = get(m_mediaUrl);
+        m_reply = reply;
+        connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+            m_reply = nullptr;
+            reply->deleteLater();
+            if (m_stopped) return;
+            if (reply->error() != QNetworkReply::NoError) {
+                retryLater(reply->errorString());
+                return;
+            }
+            parseMedia(reply->url(), reply->readAll());
+        });
+    }
+
+    void parseMedia(const QUrl &base, const QByteArray &body) {
+        int targetDuration = 6;
+        qint64 firstSeq = 0;
+        bool ended = false;
+        QVector<QUrl> segments;
+        QList<QByteArray> lines = body.split('\n');
+        for (int i = 0; i < lines.size(); ++i) {
+            QByteArray line = lines[i].trimmed();
+            if (line.startsWith("#EXT-X-TARGETDURATION:")) {
+                targetDuration = qMax(1, line.mid(22).toInt());
+            } else if (line.startsWith("#EXT-X-MEDIA-SEQUENCE:")) {
+                firstSeq = line.mid(22).toLongLong();
+            } else if (line.startsWith("#EXT-X-ENDLIST")) {
+                ended = true;
+            } else if (line.startsWith("#EXT-X-MAP") ||
+                       (line.startsWith("#EXT-X-KEY") && !line.contains("METHOD=NONE"))) {
+                // Segments are written back to back as one byte stream, which
+                // only plays for self-contained, unencrypted MPEG-TS.
+                m_stopped = true;
+                m_timer->stop();
+                emit failed(line.startsWith("#EXT-X-MAP") ? "fragmented MP4 streams are not supported"
+                                                          : "encrypted streams are not supported");
+                return;
+            } else if (!line.isEmpty() && !line.startsWith('#')) {
+                segments.append(base.resolved(QUrl(QString::fromUtf8(line))));
+            }
+        }
+
+        qint64 endSeq = firstSeq + segments.size();
+        if (m_nextSeq < 0) m_nextSeq = qMax(firstSeq, endSeq - 3);
+        if (m_nextSeq < firstSeq) m_nextSeq = firstSeq;
+        for (qint64 seq = m_nextSeq; seq < endSeq; ++seq) {
+            m_segments.append(segments[static_cast<int>(seq - firstSeq)]);
+        }
+        m_nextSeq = qMax(m_nextSeq, endSeq);
+
+        if (!m_segmentReply) fetchNextSegment();
+        if (!ended) m_timer->start(qMax(1000, targetDuration * 500));
+    }
+
+    void fetchNextSegment() {
+        if (m_stopped || m_segments.isEmpty()) return;
+        QNetworkReply *reply = get(m_segments.takeFirst());
+        m_segmentReply = reply;
+        connect(reply, &QNetworkReply::readyRead, this, [this, reply]() { deliver(reply->readAll()); });
+        connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+            m_segmentReply = nullptr;
+            reply->deleteLater();
+            if (m_stopped) return;
+            deliver(reply->readAll());
+            fetchNextSegment();
+        });
+    }
+
+    void deliver(const QByteArray &data) {
+        if (data.isEmpty()) return;
+        m_failures = 0;
+        emit dataReady(data);
+    }
+
+    void retryLater(const QString &reason) {
+        if (++m_failures >= FETCH_MAX_FAILURES) {
+            emit failed(reason);
+            return;
+        }
+        m_mediaUrl = QUrl();
+        m_nextSeq = -1;
+        m_timer->start(FETCH_RETRY_MS);
+    }
+
+    QString m_url;
+    QNetworkAccessManager *m_nam = nullptr;
+    QTimer *m_timer = nullptr;
+    QNetworkReply *m_reply = nullptr;
+    QNetworkReply *m_segmentReply = nullptr;
+    QUrl m_mediaUrl;
+    QVector<QUrl> m_segments;
+    qint64 m_nextSeq = -1;
+    Mode m_mode = Detecting;
+    int m_failures = 0;
+    bool m_stopped = false;
+};
+
+// Fixed-size, file-backed byte ring. Positions are logical offsets since the
+// ring was opened; the file itself is allocated once and never grows, so the
+// oldest bytes are overwritten once the capacity is reached. One thread
+// writes, any number of readers block until their position has data.
+class TimeShiftRing {
+public:
+    ~TimeShiftRing() {
+        shutdown();
+        m_file.close();
+        QFile::remove(m_file.fileName());
+    }
+
+    bool open(const QString &path, qint64 capacity) {
+        m_file.setFileName(path);
+        if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Unbuffered)) return false;
+        if (!m_file.resize(capacity)) return false;
+        m_capacity = capacity;
+        m_clock.start();
+        return true;
+    }
+
+    // Returns false once the file cannot be written; the ring then takes no
+    // more data and readers drain what was written before the failure.
+    bool write(const QByteArray &data) {
+        if (m_writeError.loadAcquire()) return false;
+        // The position is published before the file lock is released, so a
+        // reader holding that lock always sees a write position that matches
+        // the file.
+        QMutexLocker io(&m_ioMutex);
+        qint64 pos = writePos();
+        const char *src = data.constData();
+        qint64 left = data.size();
+        while (left > 0) {
+            qint64 at = pos % m_capacity;
+            qint64 n = qMin(left, m_capacity - at);
+            if (!m_file.seek(at) || m_file.write(src, n) != n) {
+                io.unlock();
+                m_writeError.storeRelease(1);
+                shutdown();
+                return false;
+            }
+            src += n;
+            left -= n;
+            pos += n;
+        }
+        QMutexLocker state(&m_stateMutex);
+        m_writePos = pos;
+        qint64 now = m_clock.elapsed();
+        if (m_index.isEmpty() || now - m_index.last().first >= TIMESHIFT_INDEX_INTERVAL_MS) {
+            m_index.append(qMakePair(now, pos));
+            while (m_index.size() > 1 && m_index.at(1).second <= pos - m_capacity) m_index.removeFirst();
+        }
+        m_dataReady.wakeAll();
+        return true;
+    }
+
+    // True for the first caller after a write failure, so it is reported once.
+    bool takeWriteError() { return m_writeError.testAndSetOrdered(1, 2); }
+
+    // Returns the number of bytes read, 0 at end of stream or -1 if the
+    // caller cancelled. A reader that has been lapped by the writer skips
+    // ahead to the oldest byte still held.
+    qint64 read(qint64 *pos, char *buf, qint64 max, const QAtomicInt *cancel) {
+        QMutexLocker state(&m_stateMutex);
+        while (*pos >= m_writePos && !m_closed && !cancel->loadAcquire()) m_dataReady.wait(&m_stateMutex, 500);
+        if (cancel->loadAcquire()) return -1;
+        if (*pos >= m_writePos) return 0;
+        state.unlock();
+
+        // The range is worked out with the file lock held, so the writer
+        // cannot wrap around onto it before it has been copied out.
+        QMutexLocker io(&m_ioMutex);
+        state.relock();
+        *pos = qMax(*pos, m_writePos - m_capacity);
+        qint64 at = *pos % m_capacity;
+        qint64 n = qMin(qMin(max, m_writePos - *pos), m_capacity - at);
+        state.unlock();
+        m_file.seek(at);
+        qint64 got = m_file.read(buf, n);
+        if (got > 0) *pos += got;
+        return got;
+    }
+
+    void shutdown() {
+        QMutexLocker state(&m_stateMutex);
+        m_closed = true;
+        m_dataReady.wakeAll();
+    }
+
+    void wakeReaders() { m_dataReady.wakeAll(); }
+
+    qint64 writePos() const {
+        QMutexLocker state(&m_stateMutex);
+        return m_writePos;
+    }
+
+    qint64 oldestPos() const {
+        QMutexLocker state(&m_stateMutex);
+        return qMax<qint64>(0, m_writePos - m_capacity);
+    }
+
+    qint64 nowMs() const { return m_clock.elapsed(); }
+
+    qint64 offsetForTime(qint64 ms) const {
+        QMutexLocker state(&m_stateMutex);
+        qint64 oldest = qMax<qint64>(0, m_writePos - m_capacity);
+        qint64 best = m_writePos;
+        for (int i = m_index.size() - 1; i >= 0; --i) {
+            if (m_index[i].first <= ms) {
+                best = m_index[i].second;
+                break;
+            }
+            best = m_index[i].second;
+        }
+        return qMax(best, oldest);
+    }
+
+    qint64 timeForOffset(qint64 offset) const {
+        QMutexLocker state(&m_stateMutex);
+        qint64 t = m_index.isEmpty() ? 0 : m_index.first().first;
+        for (int i = 0; i < m_index.size() && m_index[i].second <= offset; ++i) t = m_index[i].first;
+        return t;
+    }
+
+    qint64 oldestMs() const { return timeForOffset(oldestPos()); }
+
+private:
+    QFile m_file;
+    QMutex m_ioMutex;
+    mutable QMutex m_stateMutex;
+    QWaitCondition m_dataReady;
+    QElapsedTimer m_clock;
+    QVector<QPair<qint64, qint64> > m_index;
+    qint64 m_capacity = 0;
+    qint64 m_writePos = 0;
+    bool m_closed = false;
+    QAtomicInt m_writeError;
+};
+
+// Records the current channel into a TimeShiftRing on a worker thread and
+// serves it back to mpv through the timeshift:// protocol. A URL of
+// timeshift://<offset> opens the ring at that logical offset; mpv sees it as
+// a plain, never-ending byte stream.
+class TimeShiftController : public QObject {
+    Q_OBJECT
+public:
+    explicit TimeShiftController(QObject *parent = nullptr) : QObject(parent) {}
+    ~TimeShiftController() override { stop(); }
+
+    void registerProtocol(mpv_handle *mpv) {
+        mpv_stream_cb_add_ro(mpv, "timeshift", this, &TimeShiftController::openStream);
+    }
+
+    bool start(const QString &url, const QString &fetchUrl, qint64 capacity) {
+        stop();
+        QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        QDir().mkpath(dir);
+        // mpv may still be reading the previous ring, which removes its own
+        // file when the last reader lets go, so every ring gets a fresh one.
+        QString prefix = QString("timeshift-%1-").arg(QCoreApplication::applicationPid());
+        if (!m_lock) {
+            // Each instance holds a lock file for its rings while it runs.
+            // Rings whose owner's lock can be taken were left behind by a run
+            // that did not exit cleanly; those of running instances stay.
+            m_lock.reset(new QLockFile(QString("%1/timeshift-%2.lock").arg(dir).arg(QCoreApplication::applicationPid())));
+            m_lock->setStaleLockTime(0);
+            m_lock->tryLock(0);
+            const QStringList rings = QDir(dir).entryList(QStringList() << "timeshift*.bin", QDir::Files);
+            for (const QString &name : rings) {
+                if (name.startsWith(prefix)) continue;
+                QStringList parts = name.split('-');
+                if (parts.size() >= 3) {
+                    QLockFile owner(QString("%1/timeshift-%2.lock").arg(dir, parts[1]));
+                    owner.setStaleLockTime(0);
+                    if (!owner.tryLock(0)) continue;
+                    owner.unlock();
+                }
+                QFile::remove(dir + "/" + name);
+            }
+        }
+        QSharedPointer<TimeShiftRing> ring(new TimeShiftRing);
+        QString path = QString("%1/%2%3.bin").arg(dir, prefix).arg(++m_ringSerial);
+        if (!ring->open(path, capacity)) return false;
+
+        m_thread = new QThread(this);
+        m_fetcher = new StreamFetcher(fetchUrl);
+        m_fetcher->moveToThread(m_thread);
+        connect(m_thread, &QThread::started, m_fetcher, &StreamFetcher::start);
+        connect(m_thread, &QThread::finished, m_fetcher, &QObject::deleteLater);
+        TimeShiftRing *sink = ring.data();
+        StreamFetcher *fetcher = m_fetcher;
+        connect(m_fetcher, &StreamFetcher::dataReady, m_fetcher, [fetcher, sink](const QByteArray &data) {
+            if (!sink->write(data) && sink->takeWriteError()) emit fetcher->failed("could not write the time-shift buffer");
+        }, Qt::DirectConnection);
+        // A failure queued before stop() must not end the next session.
+        connect(m_fetcher, &StreamFetcher::failed, this, [this, fetcher](const QString &error) {
+            if (m_fetcher == fetcher) emit failed(error);
+        });
+
+        {
+            QMutexLocker lock(&m_ringMutex);
+            m_ring = ring;
+        }
+        m_sourceUrl = url;
+        m_sessionStartMs = 0;
+        m_thread->start(QThread::LowPriority);
+        return true;
+    }
+
+    void stop() {
+        if (!m_thread) return;
+        QMetaObject::invokeMethod(m_fetcher, "stop", Qt::BlockingQueuedConnection);
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        m_fetcher = nullptr;
+
+        // mpv may still hold readers on the ring; they see end of stream
+        // and the file goes away with the last reference.
+        QMutexLocker lock(&m_ringMutex);
+        if (m_ring) m_ring->shutdown();
+        m_ring.clear();
+        m_sourceUrl.clear();
+    }
+
+    bool isActive() const { return m_thread != nullptr; }
+    QString sourceUrl() const { return m_sourceUrl; }
+
+    QString urlAt(qint64 ringMs) {
+        QSharedPointer<TimeShiftRing> ring = currentRing();
+        if (!ring) return QString();
+        qint64 offset = ring->offsetForTime(ringMs);
+        m_sessionStartMs = ring->timeForOffset(offset);
+        return QString("timeshift://%1").arg(offset);
+    }
+
+    QString liveUrl() { return urlAt(liveEdgeMs()); }
+
+    qint64 liveEdgeMs() const {
+        QSharedPointer<TimeShiftRing> ring = currentRing();
+        return ring ? qMax<qint64>(0, ring->nowMs() - TIMESHIFT_LIVE_MARGIN_MS) : 0;
+    }
+
+    qint64 oldestMs() const {
+        QSharedPointer<TimeShiftRing> ring = currentRing();
+        return ring ? ring->oldestMs() : 0;
+    }
+
+    qint64 sessionStartMs() const { return m_sessionStartMs; }
+
+signals:
+    void failed(const QString &error);
+
+private:
+    struct Reader {
+        QSharedPointer<TimeShiftRing> ring;
+        qint64 base;
+        qint64 pos;
+        QAtomicInt cancelled;
+    };
+
+    QSharedPointer<TimeShiftRing> currentRing() const {
+        QMutexLocker lock(&m_ringMutex);
+        return m_ring;
+    }
+
+    // The stream callbacks run on mpv's demuxer thread.
+    static int openStream(void *userData, char *uri, mpv_stream_cb_info *info) {
+        TimeShiftController *self = static_cast<TimeShiftController *>(userData);
+        QSharedPointer<TimeShiftRing> ring = self->currentRing();
+        if (!ring) return MPV_ERROR_LOADING_FAILED;
+        QByteArray rest = QByteArray(uri).mid(static_cast<int>(strlen("timeshift://")));
+        bool ok = false;
+        qint64 offset = rest.toLongLong(&ok);
+        Reader *r = new Reader;
+        r->ring = ring;
+        r->base = ok ? qMax(offset, ring->oldestPos()) : ring->writePos();
+        r->pos = r->base;
+        info->cookie = r;
+        info->read_fn = [](void *cookie, char *buf, uint64_t nbytes) -> int64_t {
+            Reader *rd = static_cast<Reader *>(cookie);
+            return rd->ring->read(&rd->pos, buf, static_cast<qint64>(nbytes), &rd->cancelled);
+        };
+        info->seek_fn = [](void *cookie, int64_t offset) -> int64_t {
+            Reader *rd = static_cast<Reader *>(cookie);
+            qint64 target = rd->base + offset;
+            if (target < rd->ring->oldestPos() || target > rd->ring->writePos()) return MPV_ERROR_GENERIC;
+            rd->pos = target;
+            return offset;
+        };
+        info->size_fn = nullptr;
+        info->close_fn = [](void *cookie) { delete static_cast<Reader *>(cookie); };
+#if MPV_CLIENT_API_VERSION >= MPV_MAKE_VERSION(1, 106)
+        info->cancel_fn = [](void *cookie) {
+            Reader *rd = static_cast<Reader *>(cookie);
+            rd->cancelled.storeRelease(1);
+            rd->ring->wakeReaders();
+        };
+#endif
+        return 0;
+    }
+
+    QThread *m_thread = nullptr;
+    StreamFetcher *m_fetcher = nullptr;
+    mutable QMutex m_ringMutex;
+    QSharedPointer<TimeShiftRing> m_ring;
+    QString m_sourceUrl;
+    qint64 m_sessionStartMs = 0;
+    int m_ringSerial = 0;
+    QScopedPointer<QLockFile> m_lock;
+};
+
+// Token bucket shared by all recordings so that together they never write
+// more than the configured rate to disk. A rate of 0 means unlimited.
+class DiskBandwidthLimiter {
+public:
+    DiskBandwidthLimiter() { m_clock.start(); }
+
+    void setRate(qint64 bytesPerSec) {
+        QMutexLocker lock(&m_mutex);
+        m_rate = bytesPerSec;
+        m_tokens = qMin(m_tokens, burst());
+    }
+
+    qint64 take(qint64 want) {
+        QMutexLocker lock(&m_mutex);
+        if (m_rate <= 0) return want;
+        qint64 now = m_clock.elapsed();
+        m_tokens = qMin(burst(), m_tokens + (now - m_lastRefill) * m_rate / 1000);
+        m_lastRefill = now;
+        qint64 granted = qMin(want, m_tokens);
+        m_tokens -= granted;
+        return granted;
+    }
+
+private:
+    qint64 burst() const { return qMax<qint64>(64 * 1024, m_rate / 4); }
+
+    QMutex m_mutex;
+    QElapsedTimer m_clock;
+    qint64 m_rate = 0;
+    qint64 m_tokens = 0;
+    qint64 m_lastRefill = 0;
+};
+
+// File extension for a recording, from the first bytes of the stream:
+// HLS segments may be MPEG-TS or packed audio, and plain HTTP streams can
+// be anything from Icecast MP3 to progressive MP4.
+static QString recordingExtension(const QByteArray &head) {
+    const uchar *p = reinterpret_cast<const uchar *>(head.constData());
+    int n = head.size();
+    int at = 0;
+    // Packed audio starts with an ID3 tag carrying the segment timestamp.
+    if (n >= 10 && head.startsWith("ID3")) {
+        at = 10 + ((p[6] & 0x7f) << 21 | (p[7] & 0x7f) << 14 | (p[8] & 0x7f) << 7 | (p[9] & 0x7f));
+    }
+    if (at + 4 > n) return "ts";
+    if (p[at] == 0x47 && (at + 188 >= n || p[at + 188] == 0x47)) return "ts";
+    if (p[at] == 0xff && (p[at + 1] & 0xf6) == 0xf0) return "aac";
+    if (p[at] == 0xff && (p[at + 1] & 0xe0) == 0xe0) return "mp3";
+    if (at + 8 <= n && memcmp(p + at + 4, "ftyp", 4) == 0) return "mp4";
+    if (memcmp(p + at, "FLV", 3) == 0) return "flv";
+    if (memcmp(p + at, "OggS", 4) == 0) return "ogg";
+    if (memcmp(p + at, "\x1a\x45\xdf\xa3", 4) == 0) return "mkv";
+    return "ts";
+}
+
+// Appends fetched stream bytes to the output file, paced by the shared
+// limiter. Data that cannot be written yet is held in memory up to
+// RECORD_MAX_BACKLOG, after which it is written regardless so a recording
+// never loses data to the cap. The file is created on the first data, named
+// after the base path with an extension that matches the stream.
+class RecordingWriter : public QObject {
+    Q_OBJECT
+public:
+    RecordingWriter(const QString &basePath, DiskBandwidthLimiter *limiter, QObject *parent = nullptr)
+        : QObject(parent), m_basePath(basePath), m_limiter(limiter) {}
+
+    qint64 bytesWritten() const { return m_written.loadAcquire(); }
+
+signals:
+    void failed(const QString &error);
+    void finished(const QString &path);
+
+public slots:
+    void start() {
+        m_timer = new QTimer(this);
+        m_timer->setInterval(RECORD_DRAIN_INTERVAL_MS);
+        connect(m_timer, &QTimer::timeout, this, [this]() { drain(false); });
+        m_timer->start();
+    }
+
+    void append(const QByteArray &data) {
+        if (m_failed) return;
+        if (!m_file.isOpen()) {
+            m_file.setFileName(m_basePath + "." + recordingExtension(data));
+            if (!m_file.open(QIODevice::WriteOnly)) {
+                m_failed = true;
+                emit failed(m_file.errorString());
+                return;
+            }
+        }
+        m_backlog.append(data);
+        m_pending += data.size();
+        if (m_pending > RECORD_MAX_BACKLOG) drain(true);
+    }
+
+    void finish() {
+        drain(true);
+        if (m_timer) m_timer->stop();
+        m_file.close();
+        emit finished(m_file.fileName());
+    }
+
+private:
+    void drain(bool force) {
+        if (!m_file.isOpen()) return;
+        while (!m_backlog.isEmpty()) {
+            QByteArray &front = m_backlog.first();
+            qint64 want = front.size() - m_frontOffset;
+            qint64 n = force ? want : m_limiter->take(want);
+            if (n <= 0) return;
+            if (m_file.write(front.constData() + m_frontOffset, n) != n) {
+                m_failed = true;
+                emit failed(m_file.errorString());
+                m_file.close();
+                return;
+            }
+            m_written.fetchAndAddRelease(n);
+            m_pending -= n;
+            m_frontOffset += n;
+            if (m_frontOffset < front.size()) return;
+            m_backlog.removeFirst();
+            m_frontOffset = 0;
+        }
+    }
+
+    QString m_basePath;
+    QFile m_file;
+    DiskBandwidthLimiter *m_limiter;
+    QTimer *m_timer = nullptr;
+    bool m_failed = false;
+    QList<QByteArray> m_backlog;
+    qint64 m_frontOffset = 0;
+    qint64 m_pending = 0;
+    QAtomicInteger<qint64> m_written;
+};
+
+// One channel being written to disk. HTTP(S) streams are fetched and
+// written byte-for-byte on a worker thread; other schemes go through a
+// headless mpv handle with stream-record, which remuxes without decoding
+// to an output. stop() returns at once; the writer drains its backlog on
+// the worker thread and finished() is emitted once the file is closed.
+class Recording : public QObject {
+    Q_OBJECT
+public:
+    Recording(const QString &url, const QString &fetchUrl, const QString &name, const QString &dir,
+              DiskBandwidthLimiter *limiter, QObject *parent = nullptr)
+        : QObject(parent), m_url(url), m_fetchUrl(fetchUrl), m_name(name), m_limiter(limiter) {
+        QString safe = name;
+        safe.replace(QRegularExpression("[^\\w\\- ]"), "_");
+        QString scheme = QUrl(url).scheme().toLower();
+        m_useMpv = scheme != "http" && scheme != "https";
+        // The fetched path gets its extension once the first bytes show
+        // what the stream is; mpv remuxes into Matroska, which takes any codec.
+        m_path = QString("%1/%2_%3").arg(dir, safe.trimmed(),
+                                         QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+        if (m_useMpv) m_path += ".mkv";
+    }
+
+    ~Recording() override {
+        // At shutdown the backlog is still written out, just synchronously.
+        if (m_thread) {
+            if (!m_stopping) {
+                QMetaObject::invokeMethod(m_fetcher, "stop", Qt::BlockingQueuedConnection);
+                QMetaObject::invokeMethod(m_writer, "finish", Qt::BlockingQueuedConnection);
+            }
+            m_thread->wait();
+            releaseThread();
+        }
+        stopMpv();
+    }
+
+    bool start() {
+        return m_useMpv ? startMpv() : startFetcher();
+    }
+
+    void stop() {
+        if (m_thread) {
+            if (m_stopping) return;
+            m_stopping = true;
+            QMetaObject::invokeMethod(m_fetcher, "stop", Qt::QueuedConnection);
+            QMetaObject::invokeMethod(m_writer, "finish", Qt::QueuedConnection);
+            return;
+        }
+        stopMpv();
+        emit finished();
+    }
+
+    QString streamUrl() const { return m_url; }
+    QString name() const { return m_name; }
+    QString path() const { return m_path; }
+    qint64 bytesWritten() const {
+        if (m_writer) return m_writer->bytesWritten();
+        return m_useMpv ? QFileInfo(m_path).size() : m_written;
+    }
+
+signals:
+    void failed(const QString &error);
+    void finished();
+
+private slots:
+    void onWriterFinished(const QString &path) {
+        if (!path.isEmpty()) m_path = path;
+    }
+
+    void onThreadFinished() {
+        releaseThread();
+        emit finished();
+    }
+
+    void onMpvWakeup() {
+        while (m_mpv) {
+            mpv_event *event = mpv_wait_event(m_mpv, 0);
+            if (!event || event->event_id == MPV_EVENT_NONE) break;
+            if (event->event_id == MPV_EVENT_END_FILE) {
+                mpv_event_end_file *ef = static_cast<mpv_event_end_file *>(event->data);
+                if (ef && ef->reason == MPV_END_FILE_REASON_ERROR) emit failed(mpv_error_string(ef->error));
+            }
+        }
+    }
+
+private:
+    bool startFetcher() {
+        m_thread = new QThread(this);
+        m_fetcher = new StreamFetcher(m_fetchUrl);
+        m_writer = new RecordingWriter(m_path, m_limiter);
+        m_fetcher->moveToThread(m_thread);
+        m_writer->moveToThread(m_thread);
+        connect(m_thread, &QThread::started, m_writer, &RecordingWriter::start);
+        connect(m_thread, &QThread::started, m_fetcher, &StreamFetcher::start);
+        connect(m_thread, &QThread::finished, m_fetcher, &QObject::deleteLater);
+        // Direct, so the thread also ends while the destructor waits on it.
+        connect(m_writer, &RecordingWriter::finished, m_thread, &QThread::quit, Qt::DirectConnection);
+        connect(m_writer, &RecordingWriter::finished, this, &Recording::onWriterFinished);
+        connect(m_thread, &QThread::finished, this, &Recording::onThreadFinished);
+        connect(m_fetcher, &StreamFetcher::dataReady, m_writer, &RecordingWriter::append);
+        connect(m_fetcher, &StreamFetcher::failed, this, &Recording::failed);
+        connect(m_writer, &RecordingWriter::failed, this, &Recording::failed);
+        m_thread->start(QThread::LowPriority);
+        return true;
+    }
+
+    bool startMpv() {
+        m_mpv = mpv_create();
+        if (!m_mpv) return false;
+        mpv_set_option_string(m_mpv, "vo", "null");
+        mpv_set_option_string(m_mpv, "ao", "null");
+        mpv_set_option_string(m_mpv, "vd-lavc-skipframe", "all");
+        mpv_set_option_string(m_mpv, "idle", "yes");
+        mpv_set_option_string(m_mpv, "cache", "yes");
+        mpv_set_option_string(m_mpv, "network-timeout", "15");
+        mpv_set_option_string(m_mpv, "stream-record", m_path.toUtf8().constData());
+        if (mpv_initialize(m_mpv) < 0) {
+            mpv_terminate_destroy(m_mpv);
+            m_mpv = nullptr;
+            return false;
+        }
+        mpv_set_wakeup_callback(m_mpv, [](void *ctx) {
+            QMetaObject::invokeMethod(static_cast<Recording *>(ctx), "onMpvWakeup", Qt::QueuedConnection);
+        }, this);
+        QByteArray urlBytes = m_url.toUtf8();
+        const char *cmd[] = {"loadfile", urlBytes.constData(), "replace", NULL};
+        return mpv_command(m_mpv, cmd) >= 0;
+    }
+
+    void stopMpv() {
+        if (!m_mpv) return;
+        mpv_set_wakeup_callback(m_mpv, nullptr, nullptr);
+        mpv_terminate_destroy(m_mpv);
+        m_mpv = nullptr;
+    }
+
+    // The writer is deleted here, after the thread has ended, so
+    // bytesWritten() never sees one that is already gone.
+    void releaseThread() {
+        if (!m_thread) return;
+        // finished() is emitted just before the thread returns.
+        m_thread->wait();
+        m_written = m_writer->bytesWritten();
+        delete m_writer;
+        delete m_thread;
+        m_thread = nullptr;
+        m_fetcher = nullptr;
+        m_writer = nullptr;
+    }
+
+    QString m_url;
+    QString m_fetchUrl;
+    QString m_name;
+    QString m_path;
+    DiskBandwidthLimiter *m_limiter;
+    bool m_useMpv = false;
+    bool m_stopping = false;
+    qint64 m_written = 0;
+    QThread *m_thread = nullptr;
+    StreamFetcher *m_fetcher = nullptr;
+    RecordingWriter *m_writer = nullptr;
+    mpv_handle *m_mpv = nullptr;
+};
+
+class RecordingManager : public QObject {
+    Q_OBJECT
+public:
+    struct Schedule {
+        QString url;
+        QString name;
+        QDateTime start;
+        QDateTime stop;
+    };
+
+    explicit RecordingManager(QObject *parent = nullptr) : QObject(parent) {
+        m_dir = QStandardPaths::writableLocation(QStandardPaths::MoviesLocation) + "/LiveTV Recordings";
+        m_timer = new QTimer(this);
+        m_timer->setInterval(RECORD_SCHEDULE_CHECK_MS);
+        connect(m_timer, &QTimer::timeout, this, &RecordingManager::tick);
+        m_timer->start();
+    }
+
+    ~RecordingManager() override { stopAll(); }
+
+    void setDiskRate(qint64 bytesPerSec) { m_limiter.setRate(bytesPerSec); }
+    void setRelay(const StreamRelay *relay) { m_relay = relay; }
+
+    bool isRecording(const QString &url) const { return m_active.contains(url); }
+    int activeCount() const { return m_active.size(); }
+
+    bool startRecording(const QString &url, const QString &name, const QDateTime &stopAt = QDateTime()) {
+        if (url.isEmpty() || m_active.contains(url)) return false;
+        QDir().mkpath(m_dir);
+        QString fetchUrl = m_relay ? m_relay->relayUrl(url) : url;
+        Recording *rec = new Recording(url, fetchUrl, name, m_dir, &m_limiter, this);
+        if (!rec->start()) {
+            delete rec;
+            emit statusMessage("Could not start recording: " + name);
+            return false;
+        }
+        connect(rec, &Recording::failed, this, [this, url, name](const QString &error) {
+            emit statusMessage(QString("Recording of %1 failed: %2").arg(name, error));
+            stopRecording(url);
+        });
+        m_active.insert(url, rec);
+        if (stopAt.isValid()) m_stopAt.insert(url, stopAt);
+        emit statusMessage(QString("Recording %1 to %2").arg(name, QDir::toNativeSeparators(m_dir)));
+        return true;
+    }
+
+    // The file is reported once the writer has drained its backlog.
+    void stopRecording(const QString &url) {
+        Recording *rec = m_active.take(url);
+        m_stopAt.remove(url);
+        if (!rec) return;
+        connect(rec, &Recording::finished, this, [this, rec]() {
+            emit statusMessage(QString("Saved recording of %1 to %2 (%3 MiB)")
+                                   .arg(rec->name(), QDir::toNativeSeparators(rec->path()))
+                                   .arg(rec->bytesWritten() / (1024 * 1024)));
+            rec->deleteLater();
+        });
+        rec->stop();
+    }
+
+    void stopAll() {
+        QStringList urls = m_active.keys();
+        for (int i = 0; i < urls.size(); ++i) stopRecording(urls[i]);
+    }
+
+    void addSchedule(const Schedule &sched) {
+        m_schedules.append(sched);
+        emit schedulesChanged();
+    }
+    const QVector<Schedule> &schedules() const { return m_schedules; }
+
+    // Schedules whose window ended while the app was closed are dropped and
+    // returned so the caller can tell the user.
+    QVector<Schedule> setSchedules(const QVector<Schedule> &schedules) {
+        QDateTime now = QDateTime::currentDateTime();
+        QVector<Schedule> missed;
+        m_schedules.clear();
+        for (int i = 0; i < schedules.size(); ++i) {
+            if (schedules[i].stop <= now) missed.append(schedules[i]);
+            else m_schedules.append(schedules[i]);
+        }
+        return missed;
+    }
+
+signals:
+    void statusMessage(const QString &message);
+    void schedulesChanged();
+
+private:
+    void tick() {
+        QDateTime now = QDateTime::currentDateTime();
+        int scheduled = m_schedules.size();
+        for (int i = m_schedules.size() - 1; i >= 0; --i) {
+            const Schedule &sc = m_schedules[i];
+            if (now < sc.start) continue;
+            if (now < sc.stop) startRecording(sc.url, sc.name, sc.stop);
+            else emit statusMessage("Missed scheduled recording of " + sc.name);
+            m_schedules.remove(i);
+        }
+        if (m_schedules.size() != scheduled) emit schedulesChanged();
+        QStringList expired;
+        for (QHash<QString, QDateTime>::const_iterator it = m_stopAt.constBegin(); it != m_stopAt.constEnd(); ++it) {
+            if (now >= it.value()) expired.append(it.key());
+        }
+        for (int i = 0; i < expired.size(); ++i) stopRecording(expired[i]);
+    }
+
+    DiskBandwidthLimiter m_limiter;
+    const StreamRelay *m_relay = nullptr;
+    QString m_dir;
+    QTimer *m_timer;
+    QHash<QString, Recording *> m_active;
+    QHash<QString, QDateTime> m_stopAt;
+    QVector<Schedule> m_schedules;
+};
+
+// Owns quality.log on its own thread, so stalls and reconnects are logged
+// without a write and flush on the GUI thread for every event.
+class QualityLogWriter : public QObject {
+    Q_OBJECT
+public:
+    explicit QualityLogWriter(const QString &path, QObject *parent = nullptr) : QObject(parent) {
+        m_file.setFileName(path);
+    }
+
+public slots:
+    void append(const QByteArray &line) {
+        if (!m_file.isOpen()) {
+            if (m_file.size() > QUALITY_LOG_MAX_BYTES) rotate();
+            if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) return;
+        }
+        m_file.write(line);
+        m_file.flush();
+        // The log stays open for the whole session, so it has to be rotated
+        // as it grows and not only when it is next opened.
+        if (m_file.size() > QUALITY_LOG_MAX_BYTES) {
+            m_file.close();
+            rotate();
+        }
+    }
+
+    void close() { m_file.close(); }
+
+private:
+    void rotate() {
+        QFile::remove(m_file.fileName() + ".1");
+        QFile::rename(m_file.fileName(), m_file.fileName() + ".1");
+    }
+
+    QFile m_file;
+};
+
+class QualityLog {
+public:
+    struct Stats {
+        int rebuffers = 0;
+        qint64 rebufferMs = 0;
+        int reconnects = 0;
+        int errors = 0;
+    };
+
+    QualityLog() {
+        QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dir);
+        m_thread = new QThread;
+        m_writer = new QualityLogWriter(dir + "/quality.log");
+        m_writer->moveToThread(m_thread);
+        QObject::connect(m_thread, &QThread::finished, m_writer, &QObject::deleteLater);
+        m_thread->start();
+    }
+
+    ~QualityLog() {
+        QMetaObject::invokeMethod(m_writer, "close", Qt::BlockingQueuedConnection);
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+    }
+
+    Stats &stats(const QString &url) { return m_stats[url]; }
+
+    void record(const QString &channel, const QString &url, const QString &event, const QString &detail = QString()) {
+        QString line = QString("%1\t%2\t%3\t%4\t%5\n")
+                           .arg(QDateTime::currentDateTime().toString(Qt::ISODate), channel, event, detail, url);
+        QMetaObject::invokeMethod(m_writer, "append", Qt::QueuedConnection, Q_ARG(QByteArray, line.toUtf8()));
+    }
+
+private:
+    QThread *m_thread;
+    QualityLogWriter *m_writer;
+    QHash<QString, Stats> m_stats;
+};
+
+// Smoothed download throughput in bits per second. Transfers too small to
+// get past connection setup and TCP slow start say more about latency than
+// bandwidth and are ignored.
+class BandwidthEstimator {
+public:
+    void addTransfer(qint64 bytes, qint64 ms) {
+        if (bytes < HLS_MIN_SAMPLE_BYTES || ms <= 0) return;
+        addRate(bytes * 8000.0 / ms);
+    }
+
+    void addRate(double bitsPerSecond) {
+        if (bitsPerSecond <= 0) return;
+        m_estimate = m_hasEstimate ? m_estimate + (bitsPerSecond - m_estimate) * HLS_ESTIMATE_WEIGHT_PERCENT / 100.0
+                                   : bitsPerSecond;
+        m_hasEstimate = true;
+    }
+
+    bool hasEstimate() const { return m_hasEstimate; }
+    double estimate() const { return m_estimate; }
+
+private:
+    double m_estimate = 0;
+    bool m_hasEstimate = false;
+};
+
+// Owns the history journal file on its own thread. Records are flushed as
+// they arrive, so a crash loses at most the one being written.
+class HistoryWriter : public QObject {
+    Q_OBJECT
+public:
+    explicit HistoryWriter(const QString &path, QObject *parent = nullptr) : QObject(parent) {
+        m_file.setFileName(path);
+    }
+
+public slots:
+    void append(const QByteArray &record) {
+        if (!m_file.isOpen() && !m_file.open(QIODevice::WriteOnly | QIODevice::Append)) return;
+        m_file.write(record);
+        m_file.flush();
+    }
+
+    // Replaces the journal with a snapshot. Records queued after the snapshot
+    // was taken arrive after this call and are appended to the new file.
+    void compact(const QByteArray &snapshot) {
+        m_file.close();
+        QSaveFile out(m_file.fileName());
+        if (!out.open(QIODevice::WriteOnly)) return;
+        out.write(snapshot);
+        out.commit();
+    }
+
+    void close() { m_file.close(); }
+
+private:
+    QFile m_file;
+};
+
+// Watch history and favorites as an append-only journal. The file is replayed
+// once at startup into in-memory indexes that the GUI reads directly; updates
+// change the indexes immediately and queue the record to the writer thread.
+// Once dead records outnumber live state the journal is rewritten as a
+// snapshot.
+//
+//   Z <time> <url>              zap
+//   W <time> <ms> <url>         watch time
+//   F <time> <0|1> <url>        favorite removed/added
+//   S <plays> <last> <ms> <url> snapshot of one stream
+class HistoryStore : public QObject {
+    Q_OBJECT
+public:
+    explicit HistoryStore(const QString &path, QObject *parent = nullptr) : QObject(parent) {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        bool torn = replay(path);
+
+        m_thread = new QThread(this);
+        m_writer = new HistoryWriter(path);
+        m_writer->moveToThread(m_thread);
+        connect(m_thread, &QThread::finished, m_writer, &QObject::deleteLater);
+        m_thread->start();
+
+        // A record cut short by a crash would swallow the next append.
+        if (torn) compact();
+        else maybeCompact();
+    }
+
+    ~HistoryStore() override {
+        QMetaObject::invokeMethod(m_writer, "close", Qt::BlockingQueuedConnection);
+        m_thread->quit();
+        m_thread->wait();
+    }
+
+    const QHash<QString, WatchStat> &stats() const { return m_stats; }
+    const QSet<QString> &favorites() const { return m_favorites; }
+    bool isFavorite(const QString &url) const { return m_favorites.contains(url); }
+
+    QSet<QString> recent(int limit) const {
+        QVector<QPair<qint64, QString> > order;
+        order.reserve(m_stats.size());
+        for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it) {
+            if (it->lastWatched > 0) order.append(qMakePair(it->lastWatched, it.key()));
+        }
+        int n = qMin(limit, order.size());
+        std::partial_sort(order.begin(), order.begin() + n, order.end(),
+                          [](const QPair<qint64, QString> &a, const QPair<qint64, QString> &b) {
+                              return a.first > b.first;
+                          });
+        QSet<QString> urls;
+        for (int i = 0; i < n; ++i) urls.insert(order[i].second);
+        return urls;
+    }
+
+    void recordZap(const QString &url) {
+        qint64 now = QDateTime::currentMSecsSinceEpoch();
+        WatchStat &stat = m_stats[url];
+        stat.plays++;
+        stat.lastWatched = now;
+        write(QString("Z\t%1\t%2\n").arg(now).arg(url));
+    }
+
+    void recordWatch(const QString &url, qint64 ms) {
+        if (url.isEmpty() || ms <= 0) return;
+        m_stats[url].watchMs += ms;
+        write(QString("W\t%1\t%2\t%3\n").arg(QDateTime::currentMSecsSinceEpoch()).arg(ms).arg(url));
+    }
+
+    void setFavorite(const QString &url, bool favorite) {
+        if (url.isEmpty() || m_favorites.contains(url) == favorite) return;
+        if (favorite) m_favorites.insert(url);
+        else m_favorites.remove(url);
+        write(QString("F\t%1\t%2\t%3\n").arg(QDateTime::currentMSecsSinceEpoch()).arg(favorite ? 1 : 0).arg(url));
+        emit favoritesChanged();
+    }
+
+signals:
+    void favoritesChanged();
+
+private:
+    bool replay(const QString &path) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) return false;
+        while (!file.atEnd()) {
+            QByteArray line = file.readLine();
+            if (!line.endsWith('\n')) return true;
+            line.chop(1);
+            QList<QByteArray> f = line.split('\t');
+            if (f.isEmpty()) continue;
+            QString url = QString::fromUtf8(f.last());
+            if (f[0] == "Z" && f.size() == 3) {
+                WatchStat &stat = m_stats[url];
+                stat.plays++;
+                stat.lastWatched = qMax(stat.lastWatched, f[1].toLongLong());
+            } else if (f[0] == "W" && f.size() == 4) {
+                m_stats[url].watchMs += f[2].toLongLong();
+            } else if (f[0] == "F" && f.size() == 4) {
+                if (f[2] == "1") m_favorites.insert(url);
+                else m_favorites.remove(url);
+            } else if (f[0] == "S" && f.size() == 5) {
+                WatchStat &stat = m_stats[url];
+                stat.plays = f[1].toInt();
+                stat.lastWatched = f[2].toLongLong();
+                stat.watchMs = f[3].toLongLong();
+            } else {
+                continue;
+            }
+            m_records++;
+        }
+        return false;
+    }
+
+    void write(const QString &record) {
+        QMetaObject::invokeMethod(m_writer, "append", Qt::QueuedConnection, Q_ARG(QByteArray, record.toUtf8()));
+        m_records++;
+        maybeCompact();
+    }
+
+    void maybeCompact() {
+        if (m_records > qMax(HISTORY_COMPACT_MIN_RECORDS, 4 * (m_stats.size() + m_favorites.size()))) compact();
+    }
+
+    void compact() {
+        QByteArray snapshot;
+        for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it) {
+            snapshot += QString("S\t%1\t%2\t%3\t%4\n")
+                            .arg(it->plays).arg(it->lastWatched).arg(it->watchMs).arg(it.key()).toUtf8();
+        }
+        for (auto it = m_favorites.constBegin(); it != m_favorites.constEnd(); ++it) {
+            snapshot += QString("F\t0\t1\t%1\n").arg(*it).toUtf8();
+        }
+        m_records = m_stats.size() + m_favorites.size();
+        QMetaObject::invokeMethod(m_writer, "compact", Qt::QueuedConnection, Q_ARG(QByteArray, snapshot));
     }
+
+    QThread *m_thread;
+    HistoryWriter *m_writer;
+    QHash<QString, WatchStat> m_stats;
+    QSet<QString> m_favorites;
+    int m_records = 0;
 };
 
-class StatusIndicator : public QWidget {
+class PlaybackWatchdog : public QObject {
     Q_OBJECT
-    Q_PROPERTY(QColor dotColor READ dotColor WRITE setDotColor)
 public:
-    enum Status { Offline, Connecting, Online };
-
-    explicit StatusIndicator(QWidget *parent = nullptr) : QWidget(parent), m_status(Offline) {
-        setFixedSize(140, 32);
-        m_dotColor = QColor(239, 68, 68);
-        m_pulseTimer = new QTimer(this);
-        m_pulseTimer->setInterval(1200);
-        connect(m_pulseTimer, &QTimer::timeout, this, [this]() {
-            m_pulsePhase = !m_pulsePhase;
-            update();
+    explicit PlaybackWatchdog(QualityLog *log, QObject *parent = nullptr) : QObject(parent), m_log(log) {
+        m_stallTimer = new QTimer(this);
+        m_stallTimer->setSingleShot(true);
+        m_stallTimer->setInterval(STALL_RECONNECT_MS);
+        connect(m_stallTimer, &QTimer::timeout, this, [this]() {
+            if (!scheduleReconnect("stall")) emit gaveUp("Stream stalled");
         });
-    }
 
-    void setStatus(Status s) {
-        m_status = s;
-        switch (s) {
-            case Offline:
-                m_dotColor = QColor(239, 68, 68);
-                m_statusText = "Offline";
-                m_pulseTimer->stop();
-                break;
-            case Connecting:
-                m_dotColor = QColor(251, 191, 36);
-                m_statusText = "Connecting...";
-                m_pulseTimer->start();
-                break;
-            case Online:
-                m_dotColor = QColor(34, 197, 94);
-                m_statusText = "Online";
-                m_pulseTimer->stop();
-                break;
-        }
-        update();
+        m_reconnectTimer = new QTimer(this);
+        m_reconnectTimer->setSingleShot(true);
+        connect(m_reconnectTimer, &QTimer::timeout, this, [this]() { emit reconnectRequested(m_attempts); });
+
+        m_stableTimer = new QTimer(this);
+        m_stableTimer->setSingleShot(true);
+        m_stableTimer->setInterval(STABLE_PLAYBACK_MS);
+        connect(m_stableTimer, &QTimer::timeout, this, [this]() { m_attempts = 0; });
     }
 
-    Status status() const { return m_status; }
-    QColor dotColor() const { return m_dotColor; }
-    void setDotColor(const QColor &c) { m_dotColor = c; update(); }
+    void startSession(const QString &url, const QString &channel) {
+        endStall();
+        m_url = url;
+        m_channel = channel;
+        m_attempts = 0;
+        m_reconnectTimer->stop();
+        m_stableTimer->stop();
+    }
 
-protected:
-    void paintEvent(QPaintEvent *) override {
-        QPainter p(this);
-        p.setRenderHint(QPainter::Antialiasing);
+    void onLoadStarted() {
+        endStall();
+        m_pausedForCache = false;
+        m_underrun = false;
+        m_stableTimer->stop();
+    }
 
-        QPainterPath bg;
-        bg.addRoundedRect(rect().adjusted(1, 1, -1, -1), 14, 14);
-        p.fillPath(bg, QColor(30, 32, 48, 200));
-        p.setPen(QPen(QColor(255, 255, 255, 20), 1));
-        p.drawPath(bg);
+    void onPlaybackStarted() { m_stableTimer->start(); }
 
-        int dotX = 16, dotY = height() / 2;
-        if (m_status == Connecting && m_pulsePhase) {
-            p.setPen(Qt::NoPen);
-            QColor pulse = m_dotColor;
-            pulse.setAlpha(60);
-            p.setBrush(pulse);
-            p.drawEllipse(QPoint(dotX, dotY), 8, 8);
+    void onPlaybackEnded(bool error) {
+        endStall();
+        m_stableTimer->stop();
+        if (error) {
+            m_log->stats(m_url).errors++;
+            m_log->record(m_channel, m_url, "error");
         }
+    }
 
-        p.setPen(Qt::NoPen);
-        p.setBrush(m_dotColor);
-        p.drawEllipse(QPoint(dotX, dotY), 5, 5);
-
-        p.setPen(QColor(220, 225, 235));
-        QFont f = font();
-        f.setPixelSize(11);
-        f.setBold(true);
-        p.setFont(f);
-        p.drawText(QRect(30, 0, width() - 36, height()), Qt::AlignLeft | Qt::AlignVCenter, m_statusText);
+    void setPausedForCache(bool on) { m_pausedForCache = on; updateStall(); }
+    void setUnderrun(bool on) { m_underrun = on; updateStall(); }
+    void setBufferingPercent(int pct) { m_bufferingPercent = pct; }
+    void setCacheDuration(double secs) { m_cacheDuration = secs; }
+
+    bool isStalled() const { return m_stalled; }
+    int bufferingPercent() const { return m_bufferingPercent; }
+
+    // Reconnects back off exponentially; once MAX_RECONNECT_ATTEMPTS have
+    // failed without a stable stretch of playback in between, the caller
+    // gets false and should give up on this URL.
+    bool scheduleReconnect(const QString &reason) {
+        if (m_attempts >= MAX_RECONNECT_ATTEMPTS) return false;
+        int delay = RECONNECT_BASE_MS << m_attempts;
+        ++m_attempts;
+        m_log->stats(m_url).reconnects++;
+        m_log->record(m_channel, m_url, "reconnect",
+                      QString("%1 attempt=%2 delay=%3ms").arg(reason).arg(m_attempts).arg(delay));
+        m_reconnectTimer->start(delay);
+        return true;
     }
 
+signals:
+    void stalled(int bufferingPercent);
+    void reconnectRequested(int attempt);
+    void gaveUp(const QString &reason);
+
 private:
-    Status m_status;
-    QColor m_dotColor;
-    QString m_statusText = "Offline";
-    QTimer *m_pulseTimer;
-    bool m_pulsePhase = false;
+    void updateStall() {
+        bool stalled = m_pausedForCache || m_underrun;
+        if (!stalled) {
+            endStall();
+            return;
+        }
+        if (m_stalled) return;
+        m_stalled = true;
+        m_stallClock.start();
+        m_stallTimer->start();
+        m_stableTimer->stop();
+        m_log->stats(m_url).rebuffers++;
+        m_log->record(m_channel, m_url, "rebuffer-start",
+                      QString("cache=%1s buffering=%2%").arg(m_cacheDuration, 0, 'f', 1).arg(m_bufferingPercent));
+        emit stalled(m_bufferingPercent);
+    }
+
+    void endStall() {
+        if (!m_stalled) return;
+        m_stalled = false;
+        m_stallTimer->stop();
+        qint64 ms = m_stallClock.elapsed();
+        QualityLog::Stats &st = m_log->stats(m_url);
+        st.rebufferMs += ms;
+        m_log->record(m_channel, m_url, "rebuffer-end",
+                      QString("duration=%1ms total=%2 rebuffers/%3ms").arg(ms).arg(st.rebuffers).arg(st.rebufferMs));
+        m_stableTimer->start();
+    }
+
+    QualityLog *m_log;
+    QTimer *m_stallTimer;
+    QTimer *m_reconnectTimer;
+    QTimer *m_stableTimer;
+    QElapsedTimer m_stallClock;
+    QString m_url;
+    QString m_channel;
+    int m_attempts = 0;
+    int m_bufferingPercent = 0;
+    double m_cacheDuration = 0.0;
+    bool m_pausedForCache = false;
+    bool m_underrun = false;
+    bool m_stalled = false;
 };
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
 public:
-    explicit MainWindow(QWidget *parent = nullptr) : QMainWindow(parent) {
+    explicit MainWindow(const StartupOptions &options, QWidget *parent = nullptr)
+        : QMainWindow(parent), m_options(options), m_playlistUrl(options.playlistUrl),
+          m_logoAtlas(qApp->devicePixelRatio()) {
         setWindowTitle("Live TV Player");
         resize(1280, 720);
         setMinimumSize(900, 550);
 
-        m_nam = new QNetworkAccessManager(this);
-        m_logoNam = new QNetworkAccessManager(this);
+        m_net = new NetworkLayer(this);
+        // Playlist, guide and logo downloads and the relay's segment fetches
+        // all feed the estimate that picks the starting HLS variant.
+        connect(m_net, &NetworkLayer::transferred, this,
+                [this](qint64 bytes, qint64 ms) { m_bandwidth.addTransfer(bytes, ms); });
+        m_prober = new StreamProber(m_net, this);
+        m_logoDownloader = new LogoDownloader(m_net, this);
+        connect(m_logoDownloader, &LogoDownloader::downloaded, this, &MainWindow::onLogoDownloaded);
+
+        m_relayThread = new QThread(this);
+        m_relay = new StreamRelay;
+        m_relay->moveToThread(m_relayThread);
+        connect(m_relay, &StreamRelay::transferred, this,
+                [this](qint64 bytes, qint64 ms) { m_bandwidth.addTransfer(bytes, ms); });
+        connect(m_relayThread, &QThread::finished, m_relay, &QObject::deleteLater);
+        m_relayThread->start();
+        QMetaObject::invokeMethod(m_relay, "start", Qt::BlockingQueuedConnection);
+
+        m_history = new HistoryStore(
+            QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/history.journal", this);
+        connect(m_history, &HistoryStore::favoritesChanged, this, [this]() {
+            if (m_currentCategoryKind == FavoritesCategory) applyCategoryFilter(m_currentCategoryKind, m_currentCategory);
+        });
+
+        qRegisterMetaType<EpgGuidePtr>("EpgGuidePtr");
+        m_epgThread = new QThread(this);
+        m_epgLoader = new EpgLoader;
+        m_epgLoader->moveToThread(m_epgThread);
+        connect(m_epgThread, &QThread::finished, m_epgLoader, &QObject::deleteLater);
+        connect(m_epgLoader, &EpgLoader::parsed, this, &MainWindow::onGuideParsed);
+        connect(m_epgLoader, &EpgLoader::failed, this, [this](const QString &message, int generation) {
+            if (generation == m_guideGeneration) statusBar()->showMessage(message, 5000);
+        });
+        m_epgThread->start();
+
+        m_governor = new ActivityGovernor(this);
+        connect(m_governor, &ActivityGovernor::stateChanged, this, &MainWindow::applyActivity);
+        connect(m_governor, &ActivityGovernor::shedRequested, this, &MainWindow::shedMemory);
+
+        m_previewGrabber = new PreviewGrabber(qApp->devicePixelRatio(), this);
+        connect(m_previewGrabber, &PreviewGrabber::previewReady, this, [this]() {
+            m_channelView->viewport()->update();
+        });
+
+        m_timeShift = new TimeShiftController(this);
+        m_recorder = new RecordingManager(this);
+        m_recorder->setRelay(m_relay);
+        connect(m_recorder, &RecordingManager::statusMessage, this, [this](const QString &msg) {
+            statusBar()->showMessage(msg, 5000);
+        });
+        // Saved as they change so a crash or a killed session does not lose
+        // a recording scheduled for later.
+        connect(m_recorder, &RecordingManager::schedulesChanged, this, [this]() {
+            QSettings s("LiveTVPlayer", "LiveTVPlayer");
+            saveSchedules(s);
+        });
+        // Readers blocked on the ring only return once it is shut down, so
+        // the time-shift is stopped and the channel goes back to live.
+        connect(m_timeShift, &TimeShiftController::failed, this, [this](const QString &error) {
+            QString url = m_timeShift->sourceUrl();
+            m_timeShift->stop();
+            statusBar()->showMessage("Time-shift stopped: " + error);
+            if (!url.isEmpty() && url == m_currentStreamUrl) playStream(url);
+        });
+        connect(m_prober, &StreamProber::probed, this, [this]() {
+            if (!m_probeRepaintTimer->isActive()) m_probeRepaintTimer->start();
+        });
 
         m_debounceTimer = new QTimer(this);
         m_debounceTimer->setSingleShot(true);
@@ -463,24 +5658,81 @@ public:
         m_statusCheckTimer->setInterval(STATUS_CHECK_INTERVAL_MS);
         connect(m_statusCheckTimer, &QTimer::timeout, this, &MainWindow::checkOnlineStatus);
 
+        m_probeRepaintTimer = new QTimer(this);
+        m_probeRepaintTimer->setSingleShot(true);
+        m_probeRepaintTimer->setInterval(PROBE_REPAINT_MS);
+        connect(m_probeRepaintTimer, &QTimer::timeout, this, &MainWindow::onProbeResults);
+
+        // A precise timer that fires late is the event loop's queueing delay.
+        m_lagTimer = new QTimer(this);
+        m_lagTimer->setTimerType(Qt::PreciseTimer);
+        m_lagTimer->setInterval(PROFILER_LAG_INTERVAL_MS);
+        connect(m_lagTimer, &QTimer::timeout, this, [this]() {
+            qint64 now = Profiler::nowNs();
+            if (m_lagLastNs > 0) {
+                qint64 lag = qMax<qint64>(0, now - m_lagLastNs - qint64(PROFILER_LAG_INTERVAL_MS) * 1000000);
+                Profiler::record("event loop lag", now - lag, lag);
+            }
+            m_lagLastNs = now;
+        });
+        m_lagTimer->start();
+
+        // Long sessions are credited in slices so a crash loses at most one.
+        m_watchFlushTimer = new QTimer(this);
+        m_watchFlushTimer->setInterval(HISTORY_WATCH_FLUSH_MS);
+        connect(m_watchFlushTimer, &QTimer::timeout, this, [this]() { flushWatchTime(true); });
+
+        m_visibleProbeTimer = new QTimer(this);
+        m_visibleProbeTimer->setSingleShot(true);
+        m_visibleProbeTimer->setInterval(DEBOUNCE_MS);
+        connect(m_visibleProbeTimer, &QTimer::timeout, this, &MainWindow::probeVisibleChannels);
+
+        m_watchdog = new PlaybackWatchdog(&m_qualityLog, this);
+        connect(m_watchdog, &PlaybackWatchdog::stalled, this, [this](int pct) {
+            statusBar()->showMessage(QString("Buffering %1%: %2").arg(pct).arg(m_currentChannelName));
+        });
+        connect(m_watchdog, &PlaybackWatchdog::reconnectRequested, this, &MainWindow::reconnectStream);
+        connect(m_watchdog, &PlaybackWatchdog::gaveUp, this, &MainWindow::onPlaybackGaveUp);
+
         setupUi();
         setupMpv();
+        m_osd->setMpv(m_mpvOk ? m_mpv : nullptr);
         loadSettings();
-        applyModernTheme();
+        m_logoAtlas.load(logoAtlasPath());
 
-        QTimer::singleShot(300, this, [this]() {
-            fetchPlaylist(PLAYLIST_URL);
+        // The last stream starts now and the playlist loads alongside it;
+        // reconcileSession() ties the two together once channels arrive.
+        resumeLastSession();
+        QTimer::singleShot(0, this, [this]() {
+            fetchPlaylist(m_playlistUrl);
         });
 
         m_statusCheckTimer->start();
+        m_watchFlushTimer->start();
     }
 
     ~MainWindow() override {
+        flushWatchTime(false);
         saveSettings();
+        // A shed atlas is already on disk.
+        if (!m_memoryShed) {
+            QDir().mkpath(QFileInfo(logoAtlasPath()).absolutePath());
+            m_logoAtlas.save(logoAtlasPath());
+        }
+        m_timeShift->stop();
+        m_recorder->stopAll();
+        m_osd->setMpv(nullptr);
+        if (m_swRenderer) m_swRenderer->release();
         if (m_mpv) {
             mpv_terminate_destroy(m_mpv);
             m_mpv = nullptr;
         }
+        QMetaObject::invokeMethod(m_relay, "stop", Qt::BlockingQueuedConnection);
+        m_relayThread->quit();
+        m_relayThread->wait();
+        m_epgThread->requestInterruption();
+        m_epgThread->quit();
+        m_epgThread->wait();
     }
 
 protected:
@@ -495,10 +5747,30 @@ protected:
                 if (m_isFullscreen) exitFullscreen();
                 break;
             case Qt::Key_Up:
-                zapChannel(-1);
+                if (m_mosaic->isActive()) m_mosaic->cycleFocus(-1);
+                else zapChannel(-1);
                 break;
             case Qt::Key_Down:
-                zapChannel(1);
+                if (m_mosaic->isActive()) m_mosaic->cycleFocus(1);
+                else zapChannel(1);
+                break;
+            case Qt::Key_G:
+                cycleMosaic();
+                break;
+            case Qt::Key_T:
+                toggleTimeShift();
+                break;
+            case Qt::Key_BracketLeft:
+                seekTimeShift(-TIMESHIFT_SEEK_STEP_MS);
+                break;
+            case Qt::Key_BracketRight:
+                seekTimeShift(TIMESHIFT_SEEK_STEP_MS);
+                break;
+            case Qt::Key_End:
+                jumpToLive();
+                break;
+            case Qt::Key_R:
+                toggleRecording(m_currentStreamUrl, m_currentChannelName);
                 break;
             case Qt::Key_Left:
                 changeVolume(-5);
@@ -515,6 +5787,25 @@ protected:
             case Qt::Key_Tab:
                 toggleSidebar();
                 break;
+            case Qt::Key_H:
+                toggleHideDead();
+                break;
+            case Qt::Key_B:
+                toggleFavorite(m_currentStreamUrl, m_currentChannelName);
+                break;
+            case Qt::Key_E:
+                toggleGuide();
+                break;
+            case Qt::Key_P:
+                togglePreviews();
+                break;
+            case Qt::Key_A:
+                toggleAudioOnly();
+                break;
+            case Qt::Key_F3:
+                if (event->modifiers() & Qt::ShiftModifier) exportTrace();
+                else m_profilerOverlay->toggle();
+                break;
             default:
                 QMainWindow::keyPressEvent(event);
         }
@@ -525,9 +5816,19 @@ protected:
         resetAutoHide();
     }
 
+    void changeEvent(QEvent *event) override {
+        QMainWindow::changeEvent(event);
+        if (event->type() == QEvent::WindowStateChange) {
+            updatePreviewActivity();
+            m_inBackground = isMinimized();
+            applyAudioOnly();
+            m_governor->setWindowState(isMinimized(), m_isFullscreen);
+        }
+    }
+
     void resizeEvent(QResizeEvent *event) override {
         QMainWindow::resizeEvent(event);
-        if (m_osd) m_osd->setGeometry(m_videoWidget->rect());
+        if (m_osd) m_osd->refresh();
     }
 
     bool eventFilter(QObject *obj, QEvent *event) override {
@@ -539,9 +5840,12 @@ private slots:
     void onCategoryChanged(int row) {
         if (row < 0 || row >= m_categoryList->count()) return;
         QString cat = m_categoryList->item(row)->text();
-        m_proxyModel->setCategoryFilter(cat);
+        int kind = m_categoryList->item(row)->data(Qt::UserRole).toInt();
+        applyCategoryFilter(kind, cat);
         m_currentCategory = cat;
+        m_currentCategoryKind = kind;
         updateChannelCount();
+        m_visibleProbeTimer->start();
     }
 
     void onChannelClicked(const QModelIndex &index) {
@@ -549,6 +5853,8 @@ private slots:
         m_pendingStreamUrl = index.data(StreamUrlRole).toString();
         m_pendingChannelName = index.data(NameRole).toString();
         m_pendingCategory = index.data(CategoryRole).toString();
+        m_pendingRadio = index.data(RadioRole).toBool();
+        m_pendingTvgId = index.data(TvgIdRole).toString();
         m_pendingIndex = m_channelView->currentIndex().row();
         m_pendingTotal = m_proxyModel->rowCount();
         m_debounceTimer->start();
@@ -556,81 +5862,549 @@ private slots:
 
     void doPlayChannel() {
         if (m_pendingStreamUrl.isEmpty()) return;
+        if (m_mosaic->isActive()) {
+            m_mosaic->stop();
+            m_videoStack->setCurrentWidget(m_videoWidget);
+        }
         m_statusIndicator->setStatus(StatusIndicator::Connecting);
+        flushWatchTime(false);
+        m_currentIsRadio = m_pendingRadio;
+        applyAudioOnly();
         playStream(m_pendingStreamUrl);
         m_currentChannelName = m_pendingChannelName;
+        m_currentCategoryOfStream = m_pendingCategory;
         m_currentStreamUrl = m_pendingStreamUrl;
+        m_currentMirrorKey = m_mirrorKeyByUrl.value(m_pendingStreamUrl);
+        m_triedMirrors.clear();
+        m_watchdog->startSession(m_currentStreamUrl, m_currentChannelName);
+        m_history->recordZap(m_currentStreamUrl);
         m_nowPlayingLabel->setText("  > " + m_currentChannelName);
-        if (m_osd) m_osd->showOsd(m_pendingChannelName, m_pendingCategory, m_pendingIndex, m_pendingTotal);
+        if (m_pendingTotal > 1) prewarmRows({m_pendingIndex - 1, m_pendingIndex + 1});
+        if (m_osd) {
+            m_osd->showOsd(m_pendingChannelName, m_pendingCategory, m_pendingIndex, m_pendingTotal,
+                           guideLines(m_pendingTvgId, m_pendingChannelName));
+        }
+    }
+
+    void onSearchChanged(const QString &) { m_searchDebounce->start(); }
+
+    void applySearch() {
+        m_proxyModel->setSearchFilter(m_searchEdit->text().trimmed());
+        updateChannelCount();
+        m_visibleProbeTimer->start();
+    }
+
+    void onMpvWakeup() {
+        ProfileScope scope("MainWindow::onMpvWakeup");
+        while (m_mpv) {
+            mpv_event *event = mpv_wait_event(m_mpv, 0);
+            if (!event || event->event_id == MPV_EVENT_NONE) break;
+            switch (event->event_id) {
+                case MPV_EVENT_SHUTDOWN:
+                    break;
+                case MPV_EVENT_END_FILE: {
+                    mpv_event_end_file *ef = static_cast<mpv_event_end_file *>(event->data);
+                    bool error = ef && ef->reason == MPV_END_FILE_REASON_ERROR;
+                    flushWatchTime(false);
+                    m_watchdog->onPlaybackEnded(error);
+                    if (!error) break;
+                    // Same order as stall recovery: retry this URL with
+                    // backoff, then mirrors, then give up.
+                    if (m_watchdog->scheduleReconnect("error")) {
+                        statusBar()->showMessage("Playback error, reconnecting: " + m_currentChannelName);
+                    } else {
+                        onPlaybackGaveUp("Playback error");
+                    }
+                    break;
+                }
+                case MPV_EVENT_PLAYBACK_RESTART:
+                    if (m_awaitingFirstFrame) {
+                        m_awaitingFirstFrame = false;
+                        qint64 ms = m_zapClock.elapsed();
+                        Profiler::record("zap to first frame", 0, ms * 1000000);
+                        m_qualityLog.record(m_currentChannelName, m_currentStreamUrl, "first-frame",
+                                            QString("%1 ms, hls-bitrate %2, variant %3 kbps, estimate %4 kbps")
+                                                .arg(ms)
+                                                .arg(m_variantStart)
+                                                .arg(selectedVariant().bitrate / 1000)
+                                                .arg(qint64(m_bandwidth.estimate() / 1000)));
+                    }
+                    if (!m_firstFrameReported && m_sessionResumed && m_options.launchClock.isValid()) {
+                        m_firstFrameReported = true;
+                        qint64 ms = m_options.launchClock.elapsed();
+                        Profiler::record("launch to first frame", 0, ms * 1000000);
+                        statusBar()->showMessage(QString("Playing: %1 (first frame %2 ms after launch)")
+                                                     .arg(m_currentChannelName).arg(ms), 8000);
+                    }
+                    break;
+                case MPV_EVENT_FILE_LOADED:
+                    recordZapLatency(m_currentStreamUrl, static_cast<int>(m_zapClock.elapsed()));
+                    m_watchdog->onPlaybackStarted();
+                    flushWatchTime(false);
+                    m_watchUrl = m_currentStreamUrl;
+                    m_watchClock.start();
+                    m_statusIndicator->setStatus(StatusIndicator::Online);
+                    statusBar()->showMessage("Playing: " + m_currentChannelName);
+                    break;
+                case MPV_EVENT_PROPERTY_CHANGE:
+                    onMpvPropertyChange(static_cast<mpv_event_property *>(event->data));
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    void onMpvPropertyChange(mpv_event_property *prop) {
+        if (!prop || !prop->data) return;
+        if (strcmp(prop->name, "paused-for-cache") == 0 && prop->format == MPV_FORMAT_FLAG) {
+            bool paused = *static_cast<int *>(prop->data) != 0;
+            m_watchdog->setPausedForCache(paused);
+            if (paused && !m_awaitingFirstFrame) adaptVariant(true);
+        } else if (strcmp(prop->name, "cache-buffering-state") == 0 && prop->format == MPV_FORMAT_INT64) {
+            m_watchdog->setBufferingPercent(static_cast<int>(*static_cast<int64_t *>(prop->data)));
+        } else if (strcmp(prop->name, "demuxer-cache-duration") == 0 && prop->format == MPV_FORMAT_DOUBLE) {
+            m_cacheSeconds = *static_cast<double *>(prop->data);
+            m_watchdog->setCacheDuration(m_cacheSeconds);
+        } else if (strcmp(prop->name, "demuxer-cache-state") == 0 && prop->format == MPV_FORMAT_NODE) {
+            const mpv_node *state = static_cast<mpv_node *>(prop->data);
+            const mpv_node *underrun = mpvNodeMapValue(state, "underrun");
+            m_watchdog->setUnderrun(underrun && underrun->format == MPV_FORMAT_FLAG && underrun->u.flag);
+            // Once the buffer is full a live stream is read only as fast as
+            // it is produced, so the input rate measures the link only while
+            // the buffer is still filling.
+            const mpv_node *rate = mpvNodeMapValue(state, "raw-input-rate");
+            bool filling = m_cacheSeconds * 1000 < HLS_UPSWITCH_BUFFER_MS;
+            if (filling && rate && rate->format == MPV_FORMAT_INT64 && rate->u.int64 > 0 &&
+                (!m_rateSampleClock.isValid() || m_rateSampleClock.elapsed() >= HLS_RATE_SAMPLE_MS)) {
+                m_rateSampleClock.start();
+                m_bandwidth.addRate(rate->u.int64 * 8.0);
+            }
+            if (!m_adaptClock.isValid() || m_adaptClock.elapsed() >= HLS_ADAPT_INTERVAL_MS) {
+                m_adaptClock.start();
+                adaptVariant(false);
+            }
+        }
+    }
+
+    HlsVariant selectedVariant() const {
+        QVector<HlsVariant> variants = currentVariants();
+        for (const HlsVariant &v : variants) {
+            if (v.selected) return v;
+        }
+        return HlsVariant();
+    }
+
+    QVector<HlsVariant> currentVariants() const {
+        mpv_node node;
+        if (!m_mpv || mpv_get_property(m_mpv, "track-list", MPV_FORMAT_NODE, &node) < 0) return QVector<HlsVariant>();
+        QVector<HlsVariant> variants = hlsVariants(&node);
+        mpv_free_node_contents(&node);
+        return variants;
+    }
+
+    // Moves the stream one HLS variant down when it rebuffers, or one up
+    // when the buffer is healthy and the estimate leaves headroom for it.
+    // Switching is itself a short stall, so a rebuffer right after a switch
+    // is not held against the new variant, and variants are not stepped up
+    // faster than HLS_SWITCH_HOLD_MS apart.
+    void adaptVariant(bool rebuffering) {
+        if (!m_mpvOk || m_audioOnly || m_awaitingFirstFrame || m_currentStreamUrl.isEmpty()) return;
+        if (m_variantClock.elapsed() < (rebuffering ? HLS_SWITCH_SETTLE_MS : HLS_SWITCH_HOLD_MS)) return;
+        if (!rebuffering && (m_cacheSeconds * 1000 < HLS_UPSWITCH_BUFFER_MS || !m_bandwidth.hasEstimate())) return;
+
+        QVector<HlsVariant> variants = currentVariants();
+        int current = -1;
+        for (int i = 0; i < variants.size(); ++i) {
+            if (variants[i].selected) current = i;
+        }
+        if (current < 0) return;
+        int target = current;
+        double budget = m_bandwidth.estimate() * HLS_SAFETY_PERCENT / 100;
+        if (rebuffering && current > 0) target = current - 1;
+        if (!rebuffering && current + 1 < variants.size() && variants[current + 1].bitrate <= budget) target = current + 1;
+        if (target == current) return;
+
+        const HlsVariant &v = variants[target];
+        mpv_set_property_string(m_mpv, "vid", QByteArray::number(v.videoId).constData());
+        if (v.audioId > 0) mpv_set_property_string(m_mpv, "aid", QByteArray::number(v.audioId).constData());
+        m_variantClock.start();
+        m_qualityLog.record(m_currentChannelName, m_currentStreamUrl, rebuffering ? "variant-down" : "variant-up",
+                            QString("%1 -> %2 kbps, buffer %3 s, estimate %4 kbps")
+                                .arg(variants[current].bitrate / 1000)
+                                .arg(v.bitrate / 1000)
+                                .arg(m_cacheSeconds, 0, 'f', 1)
+                                .arg(qint64(m_bandwidth.estimate() / 1000)));
+    }
+
+    void reconnectStream(int attempt) {
+        if (m_currentStreamUrl.isEmpty()) return;
+        m_statusIndicator->setStatus(StatusIndicator::Connecting);
+        statusBar()->showMessage(QString("Reconnecting (%1/%2): %3")
+                                     .arg(attempt).arg(MAX_RECONNECT_ATTEMPTS).arg(m_currentChannelName));
+        playStream(m_currentStreamUrl);
+    }
+
+    void onPlaybackGaveUp(const QString &reason) {
+        if (failoverToMirror(reason)) return;
+        m_statusIndicator->setStatus(StatusIndicator::Offline);
+        statusBar()->showMessage(reason + ": " + m_currentChannelName);
+    }
+
+    void toggleSidebar() {
+        if (m_leftPanel->isVisible()) {
+            m_leftPanel->hide();
+        } else {
+            m_leftPanel->show();
+        }
+    }
+
+    void hidePanels() {
+        if (!m_isFullscreen) return;
+        if (m_leftPanel) m_leftPanel->hide();
+        if (m_headerBar) m_headerBar->hide();
+        if (m_browserStack) m_browserStack->hide();
+        updatePreviewActivity();
+        setCursor(Qt::BlankCursor);
+    }
+
+    void showPanels() {
+        if (m_leftPanel) m_leftPanel->show();
+        if (m_headerBar) m_headerBar->show();
+        if (m_browserStack) m_browserStack->show();
+        updatePreviewActivity();
+        setCursor(Qt::ArrowCursor);
+    }
+
+    void resetAutoHide() {
+        showPanels();
+        if (m_isFullscreen) {
+            m_autoHideTimer->start();
+        }
+    }
+
+    void cycleMosaic() {
+        int next = m_mosaic->gridSize() == 0 ? 2 : m_mosaic->gridSize() == 2 ? 3 : 0;
+        if (next == 0) {
+            exitMosaic();
+            return;
+        }
+
+        int total = m_proxyModel->rowCount();
+        if (total == 0) return;
+        int start = qMax(0, m_channelView->currentIndex().row());
+        QVector<Channel> tiles;
+        for (int i = 0; i < next * next && i < total; ++i) {
+            QModelIndex idx = m_proxyModel->index((start + i) % total, 0);
+            Channel ch;
+            ch.name = idx.data(NameRole).toString();
+            ch.streamUrl = idx.data(StreamUrlRole).toString();
+            tiles.append(ch);
+        }
+
+        if (m_mpv && m_mpvOk) {
+            const char *cmd[] = {"stop", NULL};
+            mpv_command(m_mpv, cmd);
+        }
+        m_osd->hide();
+        m_videoStack->setCurrentWidget(m_mosaic);
+        m_mosaic->start(next, tiles, m_volume, m_muted);
+        m_nowPlayingLabel->setText(QString("  Mosaic %1x%1").arg(next));
+    }
+
+    void exitMosaic() {
+        if (!m_mosaic->isActive()) return;
+        m_mosaic->stop();
+        m_videoStack->setCurrentWidget(m_videoWidget);
+        if (!m_currentStreamUrl.isEmpty()) {
+            m_nowPlayingLabel->setText("  > " + m_currentChannelName);
+            m_watchdog->startSession(m_currentStreamUrl, m_currentChannelName);
+            playStream(m_currentStreamUrl);
+        } else {
+            m_nowPlayingLabel->setText("  No channel selected");
+        }
+    }
+
+    void onMosaicTileActivated(const QString &url, const QString &name) {
+        m_pendingStreamUrl = url;
+        m_pendingChannelName = name;
+        m_pendingCategory.clear();
+        m_pendingRadio = false;
+        m_pendingTvgId.clear();
+        m_pendingIndex = 0;
+        m_pendingTotal = 0;
+        doPlayChannel();
+    }
+
+    void toggleTimeShift() {
+        if (m_timeShift->isActive()) {
+            m_timeShift->stop();
+            statusBar()->showMessage("Time-shift off", 2000);
+            if (!m_currentStreamUrl.isEmpty()) playStream(m_currentStreamUrl);
+            return;
+        }
+        if (m_currentStreamUrl.isEmpty() || !m_mpvOk) return;
+        QString scheme = QUrl(m_currentStreamUrl).scheme().toLower();
+        if (scheme != "http" && scheme != "https") {
+            statusBar()->showMessage("Time-shift is only available for HTTP streams.", 3000);
+            return;
+        }
+        if (!m_timeShift->start(m_currentStreamUrl, m_relay->relayUrl(m_currentStreamUrl), qint64(m_timeShiftCapacityMb) * 1024 * 1024)) {
+            statusBar()->showMessage("Could not allocate the time-shift buffer.");
+            return;
+        }
+        statusBar()->showMessage(QString("Time-shift on (%1 MiB buffer)").arg(m_timeShiftCapacityMb), 3000);
+        playStream(m_currentStreamUrl);
+    }
+
+    qint64 timeShiftPositionMs() {
+        double pos = 0.0;
+        if (m_mpv) mpv_get_property(m_mpv, "time-pos", MPV_FORMAT_DOUBLE, &pos);
+        return m_timeShift->sessionStartMs() + static_cast<qint64>(pos * 1000.0);
+    }
+
+    void seekTimeShift(int deltaMs) {
+        if (!m_timeShift->isActive()) return;
+        qint64 live = m_timeShift->liveEdgeMs();
+        qint64 target = qBound(m_timeShift->oldestMs(), timeShiftPositionMs() + deltaMs, live);
+        loadUrl(m_timeShift->urlAt(target));
+        showTimeShiftDelay(live - target);
+    }
+
+    void jumpToLive() {
+        if (!m_timeShift->isActive()) return;
+        int pause = 0;
+        mpv_set_property(m_mpv, "pause", MPV_FORMAT_FLAG, &pause);
+        loadUrl(m_timeShift->liveUrl());
+        statusBar()->showMessage("Time-shift: live", 2000);
+    }
+
+    void showTimeShiftDelay(qint64 behindMs) {
+        qint64 secs = qMax<qint64>(0, behindMs / 1000);
+        statusBar()->showMessage(QString("Time-shift: -%1:%2 behind live")
+                                     .arg(secs / 60, 2, 10, QChar('0'))
+                                     .arg(secs % 60, 2, 10, QChar('0')), 3000);
+    }
+
+    void toggleRecording(const QString &url, const QString &name) {
+        if (url.isEmpty()) return;
+        if (m_recorder->isRecording(url)) {
+            m_recorder->stopRecording(url);
+        } else {
+            m_recorder->startRecording(url, name);
+        }
+    }
+
+    void showChannelMenu(const QPoint &pos) {
+        QModelIndex idx = m_channelView->indexAt(pos);
+        if (!idx.isValid()) return;
+        QString url = idx.data(StreamUrlRole).toString();
+        QString name = idx.data(NameRole).toString();
+
+        QMenu menu(this);
+        QAction *recordAction = menu.addAction(m_recorder->isRecording(url) ? "Stop Recording" : "Record Now");
+        QAction *scheduleAction = menu.addAction("Schedule Recording...");
+        menu.addSeparator();
+        QAction *favoriteAction = menu.addAction(m_history->isFavorite(url) ? "Remove from Favorites" : "Add to Favorites");
+        QAction *chosen = menu.exec(m_channelView->viewport()->mapToGlobal(pos));
+        if (chosen == recordAction) {
+            toggleRecording(url, name);
+        } else if (chosen == scheduleAction) {
+            scheduleRecording(url, name);
+        } else if (chosen == favoriteAction) {
+            toggleFavorite(url, name);
+        }
+    }
+
+    void toggleGuide() {
+        if (m_browserStack->currentWidget() == m_epgView) {
+            m_browserStack->setCurrentWidget(m_channelView);
+            m_channelView->scrollTo(m_channelView->currentIndex());
+            m_channelView->setFocus();
+        } else {
+            m_browserStack->setCurrentWidget(m_epgView);
+            m_epgView->scrollTo(m_epgView->currentIndex(), QAbstractItemView::PositionAtCenter);
+            m_epgView->setFocus();
+        }
+        updatePreviewActivity();
+    }
+
+    void togglePreviews() {
+        bool enabled = !m_previewGrabber->isEnabled();
+        m_previewGrabber->setEnabled(enabled);
+        statusBar()->showMessage(enabled ? "Live previews on" : "Live previews off", 3000);
+        probeVisibleChannels();
+        m_channelView->viewport()->update();
+    }
+
+    void toggleAudioOnly() {
+        m_audioOnlyPinned = !m_audioOnlyPinned;
+        applyAudioOnly();
+        statusBar()->showMessage(m_audioOnlyPinned ? "Audio only" : "Video on", 3000);
+    }
+
+    // Video is dropped for radio channels, while minimized, or on request.
+    // With vid=no mpv tears down the video decoder and output; selecting the
+    // track again resumes from the next keyframe.
+    void applyAudioOnly() {
+        bool audioOnly = m_audioOnlyPinned || m_currentIsRadio || m_inBackground;
+        if (audioOnly == m_audioOnly) return;
+        m_audioOnly = audioOnly;
+        if (m_mpv && m_mpvOk) mpv_set_property_string(m_mpv, "vid", audioOnly ? "no" : "auto");
+    }
+
+    // Probing, logo fetching and the online check only serve someone looking
+    // at the window; the lag probe and decorative animation stop with them.
+    // In the background mpv's demuxer cache shrinks as well. Everything comes
+    // back on the next Active state.
+    void applyActivity(ActivityGovernor::State state) {
+        bool active = state == ActivityGovernor::Active;
+        bool background = state == ActivityGovernor::Background;
+        m_prober->setPaused(!active);
+        m_logoDownloader->setPaused(!active);
+        m_statusIndicator->setAnimated(active);
+        if (!active) m_statusCheckTimer->stop();
+        else if (!m_statusCheckTimer->isActive()) m_statusCheckTimer->start();
+        if (!active) {
+            m_lagTimer->stop();
+        } else if (!m_lagTimer->isActive()) {
+            m_lagLastNs = 0;
+            m_lagTimer->start();
+        }
+        if (m_mpv && m_mpvOk) {
+            // The foreground sizes match setupMpv.
+            mpv_set_property_string(m_mpv, "demuxer-max-bytes", background ? "8MiB" : "50MiB");
+            mpv_set_property_string(m_mpv, "demuxer-max-back-bytes", background ? "1MiB" : "10MiB");
+        }
+        if (!background && m_memoryShed) QTimer::singleShot(0, this, &MainWindow::restoreShedMemory);
+    }
+
+    // Decoded logos and thumbnails are the bulk of the heap. The atlas goes
+    // to disk and is read back on restore.
+    void shedMemory() {
+        QDir().mkpath(QFileInfo(logoAtlasPath()).absolutePath());
+        m_logoAtlas.save(logoAtlasPath());
+        m_logoAtlas.clear();
+        m_previewGrabber->dropPreviews();
+        QPixmapCache::clear();
+        m_memoryShed = true;
+    }
+
+    void restoreShedMemory() {
+        if (!m_memoryShed) return;
+        m_memoryShed = false;
+        m_logoAtlas.load(logoAtlasPath());
+        for (int i = 0; i < m_deferredLogos.size(); ++i) onLogoDownloaded(m_deferredLogos[i].first, m_deferredLogos[i].second);
+        m_deferredLogos.clear();
+        m_channelView->viewport()->update();
     }
 
-    void onSearchChanged(const QString &) { m_searchDebounce->start(); }
+    void updatePreviewActivity() {
+        if (!m_browserStack) return;
+        bool onScreen = !isMinimized() && m_browserStack->isVisible() && m_browserStack->currentWidget() == m_channelView;
+        m_previewGrabber->setPaused(!onScreen);
+    }
 
-    void applySearch() {
-        m_proxyModel->setSearchFilter(m_searchEdit->text().trimmed());
+    void toggleFavorite(const QString &url, const QString &name) {
+        if (url.isEmpty()) return;
+        bool favorite = !m_history->isFavorite(url);
+        m_history->setFavorite(url, favorite);
+        statusBar()->showMessage((favorite ? "Added to Favorites: " : "Removed from Favorites: ") + name, 3000);
+    }
+
+    // Favorites and Recent are answered from the history indexes.
+    void applyCategoryFilter(int kind, const QString &cat) {
+        if (kind == FavoritesCategory) m_proxyModel->setUrlFilter(cat, m_history->favorites());
+        else if (kind == RecentCategory) m_proxyModel->setUrlFilter(cat, m_history->recent(HISTORY_RECENT_LIMIT));
+        else if (kind == AllCategories) m_proxyModel->setCategoryFilter(QString());
+        else m_proxyModel->setCategoryFilter(cat);
         updateChannelCount();
     }
 
-    void onMpvWakeup() {
-        while (m_mpv) {
-            mpv_event *event = mpv_wait_event(m_mpv, 0);
-            if (!event || event->event_id == MPV_EVENT_NONE) break;
-            switch (event->event_id) {
-                case MPV_EVENT_SHUTDOWN:
-                    break;
-                case MPV_EVENT_END_FILE: {
-                    mpv_event_end_file *ef = static_cast<mpv_event_end_file *>(event->data);
-                    if (ef && ef->reason == MPV_END_FILE_REASON_ERROR) {
-                        m_statusIndicator->setStatus(StatusIndicator::Offline);
-                        statusBar()->showMessage("Playback error: " + m_currentChannelName);
-                    }
-                    break;
-                }
-                case MPV_EVENT_FILE_LOADED:
-                    m_statusIndicator->setStatus(StatusIndicator::Online);
-                    statusBar()->showMessage("Playing: " + m_currentChannelName);
-                    break;
-                default:
-                    break;
-            }
-        }
+    // Credits the time since the stream started playing to its history.
+    void flushWatchTime(bool keepCounting) {
+        if (!m_watchClock.isValid()) return;
+        m_history->recordWatch(m_watchUrl, m_watchClock.elapsed());
+        if (keepCounting) m_watchClock.restart();
+        else m_watchClock.invalidate();
     }
 
-    void toggleSidebar() {
-        if (m_leftPanel->isVisible()) {
-            m_leftPanel->hide();
-        } else {
-            m_leftPanel->show();
+    void scheduleRecording(const QString &url, const QString &name) {
+        QDialog dlg(this);
+        dlg.setWindowTitle("Schedule Recording");
+        QFormLayout *form = new QFormLayout(&dlg);
+        QDateTime now = QDateTime::currentDateTime();
+        QDateTimeEdit *startEdit = new QDateTimeEdit(now.addSecs(60), &dlg);
+        QDateTimeEdit *stopEdit = new QDateTimeEdit(now.addSecs(3600), &dlg);
+        startEdit->setCalendarPopup(true);
+        stopEdit->setCalendarPopup(true);
+        form->addRow("Channel", new QLabel(name, &dlg));
+        form->addRow("Start", startEdit);
+        form->addRow("Stop", stopEdit);
+        QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dlg);
+        connect(buttons, &QDialogButtonBox::accepted, &dlg, &QDialog::accept);
+        connect(buttons, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+        form->addRow(buttons);
+        if (dlg.exec() != QDialog::Accepted) return;
+
+        RecordingManager::Schedule sched;
+        sched.url = url;
+        sched.name = name;
+        sched.start = startEdit->dateTime();
+        sched.stop = stopEdit->dateTime();
+        if (sched.stop <= sched.start || sched.stop <= now) {
+            statusBar()->showMessage("Recording must end after it starts.", 3000);
+            return;
         }
+        m_recorder->addSchedule(sched);
+        statusBar()->showMessage(QString("Scheduled %1 at %2").arg(name, sched.start.toString("ddd HH:mm")), 3000);
     }
 
-    void hidePanels() {
-        if (!m_isFullscreen) return;
-        if (m_leftPanel) m_leftPanel->hide();
-        if (m_headerBar) m_headerBar->hide();
-        if (m_channelView) m_channelView->hide();
-        setCursor(Qt::BlankCursor);
+    void exportTrace() {
+        QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        QDir().mkpath(dir);
+        QString path = QString("%1/trace-%2.json").arg(dir, QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+        if (Profiler::exportChromeTrace(path)) statusBar()->showMessage("Trace written to " + path, 5000);
+        else statusBar()->showMessage("Could not write trace to " + path, 5000);
     }
 
-    void showPanels() {
-        if (m_leftPanel) m_leftPanel->show();
-        if (m_headerBar) m_headerBar->show();
-        if (m_channelView) m_channelView->show();
-        setCursor(Qt::ArrowCursor);
+    void toggleHideDead() {
+        m_proxyModel->setHideDead(!m_proxyModel->hideDead());
+        updateChannelCount();
+        statusBar()->showMessage(m_proxyModel->hideDead() ? "Hiding offline channels" : "Showing all channels", 2000);
     }
 
-    void resetAutoHide() {
-        showPanels();
-        if (m_isFullscreen) {
-            m_autoHideTimer->start();
+    void onProbeResults() {
+        m_proxyModel->refreshLiveness();
+        if (m_proxyModel->hideDead()) updateChannelCount();
+        if (m_channelView && m_channelView->viewport()) {
+            m_channelView->viewport()->update();
+        }
+    }
+
+    void probeVisibleChannels() {
+        int total = m_proxyModel->rowCount();
+        if (total == 0) return;
+        int start = 0;
+        int end = 0;
+        m_channelView->visibleRange(&start, &end);
+
+        QStringList urls;
+        for (int i = start; i < end; ++i) {
+            urls.append(m_proxyModel->index(i, 0).data(StreamUrlRole).toString());
+        }
+        m_prober->prioritize(urls);
+
+        if (!m_previewGrabber->isEnabled()) return;
+        QStringList previewUrls;
+        for (int i = 0; i < urls.size(); ++i) {
+            if (m_prober->liveness(urls[i]) != StreamProber::Dead) previewUrls.append(urls[i]);
         }
+        m_previewGrabber->setCandidates(previewUrls);
     }
 
     void checkOnlineStatus() {
-        QUrl checkUrl(PLAYLIST_URL);
-        QNetworkRequest req(checkUrl);
-        req.setRawHeader("User-Agent", "LiveTVPlayer/2.0");
-        QNetworkReply *reply = m_nam->head(req);
+        QNetworkReply *reply = m_net->head(NetworkLayer::request(QUrl(m_playlistUrl), PLAYLIST_TIMEOUT_MS));
         connect(reply, &QNetworkReply::finished, this, [reply]() {
             reply->deleteLater();
         });
@@ -647,7 +6421,9 @@ private slots:
     void enterFullscreen() {
         m_isFullscreen = true;
         m_savedSplitterState = m_vertSplitter->saveState();
-        m_channelView->hide();
+        m_browserStack->hide();
+        updatePreviewActivity();
+        m_governor->setWindowState(isMinimized(), true);
         m_leftPanel->hide();
         m_headerBar->hide();
         showFullScreen();
@@ -661,7 +6437,9 @@ private slots:
         m_autoHideTimer->stop();
         showNormal();
         showPanels();
-        m_channelView->show();
+        m_browserStack->show();
+        updatePreviewActivity();
+        m_governor->setWindowState(isMinimized(), false);
         if (!m_savedSplitterState.isEmpty()) {
             m_vertSplitter->restoreState(m_savedSplitterState);
         }
@@ -678,7 +6456,7 @@ private:
         rootLayout->setContentsMargins(0, 0, 0, 0);
         rootLayout->setSpacing(0);
 
-        m_headerBar = new QWidget(central);
+        m_headerBar = new HeaderBar(central);
         m_headerBar->setFixedHeight(52);
         m_headerBar->setObjectName("headerBar");
         QHBoxLayout *headerLayout = new QHBoxLayout(m_headerBar);
@@ -700,6 +6478,22 @@ private:
         connect(m_searchEdit, &QLineEdit::textChanged, this, &MainWindow::onSearchChanged);
         headerLayout->addWidget(m_searchEdit);
 
+        m_sortCombo = new QComboBox(m_headerBar);
+        m_sortCombo->setObjectName("sortCombo");
+        m_sortCombo->addItem("Playlist order", CategoryFilterProxy::PlaylistOrder);
+        m_sortCombo->addItem("Name", CategoryFilterProxy::SortByName);
+        m_sortCombo->addItem("Channel number", CategoryFilterProxy::SortByNumber);
+        m_sortCombo->addItem("Most watched", CategoryFilterProxy::MostWatched);
+        m_sortCombo->addItem("Recently watched", CategoryFilterProxy::RecentlyWatched);
+        m_sortCombo->setToolTip("Sort channels");
+        m_sortCombo->setFocusPolicy(Qt::NoFocus);
+        connect(m_sortCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this,
+                [this](int) {
+                    m_proxyModel->setSortMode(
+                        static_cast<CategoryFilterProxy::SortMode>(m_sortCombo->currentData().toInt()));
+                });
+        headerLayout->addWidget(m_sortCombo);
+
         headerLayout->addStretch();
 
         m_nowPlayingLabel = new QLabel("  No channel selected", m_headerBar);
@@ -780,7 +6574,7 @@ private:
         QPushButton *refreshBtn = new QPushButton("Refresh Playlist", m_leftPanel);
         refreshBtn->setObjectName("refreshBtn");
         connect(refreshBtn, &QPushButton::clicked, this, [this]() {
-            fetchPlaylist(PLAYLIST_URL);
+            fetchPlaylist(m_playlistUrl);
         });
         leftLayout->addWidget(refreshBtn);
 
@@ -793,37 +6587,85 @@ private:
 
         m_vertSplitter = new QSplitter(Qt::Vertical, rightPanel);
 
-        m_videoWidget = new VideoWidget(m_vertSplitter);
+        m_videoStack = new QStackedWidget(m_vertSplitter);
+
+        m_videoWidget = new VideoWidget(m_videoStack);
         m_videoWidget->installEventFilter(this);
         connect(m_videoWidget, &VideoWidget::doubleClicked, this, &MainWindow::toggleFullscreen);
+        m_videoStack->addWidget(m_videoWidget);
 
-        m_vertSplitter->addWidget(m_videoWidget);
+        m_mosaic = new MosaicView(m_videoStack);
+        m_mosaic->setRenderScale(m_options.renderScale);
+        connect(m_mosaic, &MosaicView::statusMessage, this, [this](const QString &msg) {
+            statusBar()->showMessage(msg, 4000);
+        });
+        connect(m_mosaic, &MosaicView::tileActivated, this, &MainWindow::onMosaicTileActivated);
+        m_videoStack->addWidget(m_mosaic);
+
+        m_vertSplitter->addWidget(m_videoStack);
 
         m_channelModel = new ChannelModel(this);
         m_proxyModel = new CategoryFilterProxy(this);
         m_proxyModel->setSourceModel(m_channelModel);
 
-        m_channelView = new QListView(m_vertSplitter);
+        m_browserStack = new QStackedWidget(m_vertSplitter);
+
+        m_channelView = new ChannelGridView(m_browserStack);
         m_channelView->setModel(m_proxyModel);
-        m_channelView->setViewMode(QListView::IconMode);
-        m_channelView->setResizeMode(QListView::Adjust);
-        m_channelView->setMovement(QListView::Static);
         m_channelView->setSpacing(6);
-        m_channelView->setUniformItemSizes(true);
-        m_channelView->setWrapping(true);
-        m_channelView->setSelectionMode(QAbstractItemView::SingleSelection);
-        m_channelView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
-        m_channelView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
         m_channelView->setObjectName("channelGrid");
 
         m_delegate = new ChannelDelegate(this);
-        m_delegate->setLogoCache(&m_logoPixmaps);
+        m_delegate->setLogoAtlas(&m_logoAtlas);
+        connect(m_delegate, &ChannelDelegate::logoEvicted, this, [this](const QString &url) {
+            if (m_logoAtlas.forgetEvicted(url)) m_logoDownloader->refetch(url);
+        });
+        m_delegate->setProber(m_prober);
+        m_delegate->setPreviews(m_previewGrabber->previews());
+        m_proxyModel->setProber(m_prober);
+        m_proxyModel->setWatchStats(&m_history->stats());
         m_channelView->setItemDelegate(m_delegate);
 
-        connect(m_channelView, &QListView::clicked, this, &MainWindow::onChannelClicked);
-        connect(m_channelView, &QListView::activated, this, &MainWindow::onChannelClicked);
-
-        m_vertSplitter->addWidget(m_channelView);
+        connect(m_channelView, &QAbstractItemView::clicked, this, &MainWindow::onChannelClicked);
+        connect(m_channelView, &QAbstractItemView::activated, this, &MainWindow::onChannelClicked);
+        m_channelView->setContextMenuPolicy(Qt::CustomContextMenu);
+        connect(m_channelView, &QWidget::customContextMenuRequested, this, &MainWindow::showChannelMenu);
+        connect(m_channelView->verticalScrollBar(), &QScrollBar::valueChanged,
+                m_visibleProbeTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+
+        // Hovered cards are warmed once the pointer settles; the current row
+        // straight away, since a zap to it is at most a debounce away.
+        m_prewarmTimer = new QTimer(this);
+        m_prewarmTimer->setSingleShot(true);
+        m_prewarmTimer->setInterval(PREWARM_HOVER_MS);
+        connect(m_prewarmTimer, &QTimer::timeout, this, [this]() { prewarmRows({m_prewarmRow}); });
+        connect(m_channelView, &QAbstractItemView::entered, this, [this](const QModelIndex &idx) {
+            m_prewarmRow = idx.row();
+            m_prewarmTimer->start();
+        });
+        connect(m_channelView->selectionModel(), &QItemSelectionModel::currentChanged, this,
+                [this](const QModelIndex &idx) {
+                    if (idx.isValid()) prewarmRows({idx.row()});
+                });
+
+        m_profilerOverlay = new ProfilerOverlay(m_channelView);
+        connect(m_profilerOverlay, &ProfilerOverlay::refreshing, this, [this]() {
+            m_profilerOverlay->setFooter(m_governor->report());
+        });
+        m_browserStack->addWidget(m_channelView);
+
+        // The guide shows the same filtered rows and shares the current row,
+        // so zapping from either view goes through onChannelClicked.
+        m_epgView = new EpgView(m_browserStack);
+        m_epgView->setModel(m_proxyModel);
+        QItemSelectionModel *epgSelection = m_epgView->selectionModel();
+        m_epgView->setSelectionModel(m_channelView->selectionModel());
+        delete epgSelection;
+        connect(m_epgView, &QAbstractItemView::clicked, this, &MainWindow::onChannelClicked);
+        connect(m_epgView, &QAbstractItemView::activated, this, &MainWindow::onChannelClicked);
+        m_browserStack->addWidget(m_epgView);
+
+        m_vertSplitter->addWidget(m_browserStack);
         m_vertSplitter->setStretchFactor(0, 3);
         m_vertSplitter->setStretchFactor(1, 2);
 
@@ -836,164 +6678,11 @@ private:
 
         rootLayout->addWidget(hSplitter, 1);
 
-        m_osd = new OsdWidget(m_videoWidget);
-        m_osd->setGeometry(m_videoWidget->rect());
+        m_osd = new OsdOverlay(m_videoWidget, this);
 
         statusBar()->showMessage("Loading playlist...");
     }
 
-    void applyModernTheme() {
-        QString style =
-            "* {"
-            "  font-family: 'Segoe UI', 'SF Pro Display', 'Helvetica Neue', Arial, sans-serif;"
-            "}"
-            "QMainWindow, QWidget {"
-            "  background-color: #0f0f1a;"
-            "  color: #e2e8f0;"
-            "}"
-            "#headerBar {"
-            "  background: qlineargradient(x1:0, y1:0, x2:0, y2:1,"
-            "    stop:0 #1a1a2e, stop:1 #16162a);"
-            "  border-bottom: 1px solid rgba(255,255,255,0.06);"
-            "}"
-            "#appTitle {"
-            "  font-size: 16px;"
-            "  font-weight: 700;"
-            "  color: #f1f5f9;"
-            "}"
-            "#searchEdit {"
-            "  background-color: #1e1e35;"
-            "  color: #e2e8f0;"
-            "  border: 1px solid rgba(255,255,255,0.1);"
-            "  border-radius: 8px;"
-            "  padding: 6px 12px;"
-            "  font-size: 13px;"
-            "  selection-background-color: #6366f1;"
-            "}"
-            "#searchEdit:focus {"
-            "  border: 1px solid #6366f1;"
-            "  background-color: #222240;"
-            "}"
-            "#nowPlaying {"
-            "  color: #a5b4fc;"
-            "  font-size: 12px;"
-            "  font-weight: 600;"
-            "}"
-            "#channelCount {"
-            "  color: #64748b;"
-            "  font-size: 11px;"
-            "}"
-            "#volumeLabel {"
-            "  color: #94a3b8;"
-            "  font-size: 11px;"
-            "  font-weight: 600;"
-            "}"
-            "#iconBtn {"
-            "  background: rgba(255,255,255,0.05);"
-            "  border: 1px solid rgba(255,255,255,0.08);"
-            "  border-radius: 6px;"
-            "  color: #e2e8f0;"
-            "  font-size: 14px;"
-            "}"
-            "#iconBtn:hover {"
-            "  background: rgba(99,102,241,0.3);"
-            "  border-color: rgba(99,102,241,0.5);"
-            "}"
-            "#iconBtn:pressed {"
-            "  background: rgba(99,102,241,0.5);"
-            "}"
-            "#headerSep {"
-            "  background-color: rgba(255,255,255,0.04);"
-            "  border: none;"
-            "}"
-            "#leftPanel {"
-            "  background-color: #12121f;"
-            "  border-right: 1px solid rgba(255,255,255,0.04);"
-            "}"
-            "#sectionTitle {"
-            "  font-weight: 700;"
-            "  font-size: 13px;"
-            "  color: #94a3b8;"
-            "  text-transform: uppercase;"
-            "  letter-spacing: 1px;"
-            "  padding: 4px 8px;"
-            "}"
-            "#categoryList {"
-            "  background-color: transparent;"
-            "  border: none;"
-            "  outline: none;"
-            "  font-size: 13px;"
-            "}"
-            "#categoryList::item {"
-            "  padding: 8px 12px;"
-            "  border-radius: 8px;"
-            "  margin: 1px 4px;"
-            "  color: #cbd5e1;"
-            "}"
-            "#categoryList::item:selected {"
-            "  background: qlineargradient(x1:0, y1:0, x2:1, y2:0,"
-            "    stop:0 rgba(99,102,241,0.35), stop:1 rgba(99,102,241,0.15));"
-            "  color: #e0e7ff;"
-            "  border-left: 3px solid #6366f1;"
-            "}"
-            "#categoryList::item:hover:!selected {"
-            "  background-color: rgba(255,255,255,0.04);"
-            "}"
-            "#refreshBtn {"
-            "  background: rgba(99,102,241,0.15);"
-            "  border: 1px solid rgba(99,102,241,0.25);"
-            "  border-radius: 8px;"
-            "  color: #a5b4fc;"
-            "  padding: 8px;"
-            "  font-size: 12px;"
-            "  font-weight: 600;"
-            "}"
-            "#refreshBtn:hover {"
-            "  background: rgba(99,102,241,0.3);"
-            "  color: #e0e7ff;"
-            "}"
-            "#channelGrid {"
-            "  background-color: #0f0f1a;"
-            "  border: none;"
-            "  border-top: 1px solid rgba(255,255,255,0.04);"
-            "}"
-            "QSplitter::handle {"
-            "  background-color: rgba(255,255,255,0.04);"
-            "}"
-            "QSplitter::handle:horizontal { width: 1px; }"
-            "QSplitter::handle:vertical { height: 4px; }"
-            "QSplitter::handle:hover {"
-            "  background-color: rgba(99,102,241,0.4);"
-            "}"
-            "QStatusBar {"
-            "  background-color: #0a0a16;"
-            "  color: #64748b;"
-            "  font-size: 11px;"
-            "  border-top: 1px solid rgba(255,255,255,0.04);"
-            "  padding: 2px 12px;"
-            "}"
-            "QScrollBar:vertical {"
-            "  background: transparent;"
-            "  width: 8px;"
-            "  margin: 0;"
-            "}"
-            "QScrollBar::handle:vertical {"
-            "  background: rgba(148,163,184,0.2);"
-            "  border-radius: 4px;"
-            "  min-height: 30px;"
-            "}"
-            "QScrollBar::handle:vertical:hover {"
-            "  background: rgba(148,163,184,0.35);"
-            "}"
-            "QScrollBar::add-line:vertical, QScrollBar::sub-line:vertical {"
-            "  height: 0;"
-            "}"
-            "QScrollBar::add-page:vertical, QScrollBar::sub-page:vertical {"
-            "  background: transparent;"
-            "}";
-        qApp->setStyleSheet(style);
-    }
-
     void setupMpv() {
         m_mpv = mpv_create();
         if (!m_mpv) {
@@ -1002,8 +6691,9 @@ private:
             return;
         }
 
-        mpv_set_option_string(m_mpv, "hwdec", "auto");
-        mpv_set_option_string(m_mpv, "vo", "gpu");
+        bool sw = m_options.softwareRender;
+        mpv_set_option_string(m_mpv, "hwdec", sw ? "no" : "auto");
+        mpv_set_option_string(m_mpv, "vo", sw ? "libmpv" : "gpu");
         mpv_set_option_string(m_mpv, "keep-open", "yes");
         mpv_set_option_string(m_mpv, "idle", "yes");
         mpv_set_option_string(m_mpv, "input-default-bindings", "no");
@@ -1015,9 +6705,18 @@ private:
         mpv_set_option_string(m_mpv, "demuxer-max-back-bytes", "10MiB");
         mpv_set_option_string(m_mpv, "cache-secs", "10");
         mpv_set_option_string(m_mpv, "network-timeout", "15");
+        m_mpvProfile = QSettings("LiveTVPlayer", "LiveTVPlayer").value("mpvProfile").toString();
+        if (!m_mpvProfile.isEmpty()) mpv_set_option_string(m_mpv, "profile", m_mpvProfile.toUtf8().constData());
 
-        int64_t wid = static_cast<int64_t>(m_videoWidget->winId());
-        mpv_set_option(m_mpv, "wid", MPV_FORMAT_INT64, &wid);
+        if (sw) {
+            // Frames are fetched without waiting (see SoftwareRenderer), so
+            // mpv should not schedule them early for a blocking render.
+            mpv_set_option_string(m_mpv, "video-timing-offset", "0");
+        } else {
+            m_videoWidget->setAttribute(Qt::WA_NativeWindow);
+            int64_t wid = static_cast<int64_t>(m_videoWidget->winId());
+            mpv_set_option(m_mpv, "wid", MPV_FORMAT_INT64, &wid);
+        }
 
         int err = mpv_initialize(m_mpv);
         if (err < 0) {
@@ -1028,6 +6727,27 @@ private:
             return;
         }
 
+        if (sw) {
+            m_swRenderer = new SoftwareRenderer(this);
+            if (!m_swRenderer->init(m_mpv)) {
+                QMessageBox::critical(this, "Error", "Failed to create mpv software renderer.");
+                delete m_swRenderer;
+                m_swRenderer = nullptr;
+                mpv_terminate_destroy(m_mpv);
+                m_mpv = nullptr;
+                m_mpvOk = false;
+                return;
+            }
+            m_videoWidget->setSoftwareRenderer(m_swRenderer, m_options.renderScale);
+        }
+
+        m_timeShift->registerProtocol(m_mpv);
+
+        mpv_observe_property(m_mpv, 0, "paused-for-cache", MPV_FORMAT_FLAG);
+        mpv_observe_property(m_mpv, 0, "demuxer-cache-state", MPV_FORMAT_NODE);
+        mpv_observe_property(m_mpv, 0, "cache-buffering-state", MPV_FORMAT_INT64);
+        mpv_observe_property(m_mpv, 0, "demuxer-cache-duration", MPV_FORMAT_DOUBLE);
+
         mpv_set_wakeup_callback(m_mpv, [](void *ctx) {
             QMetaObject::invokeMethod(static_cast<MainWindow *>(ctx), "onMpvWakeup", Qt::QueuedConnection);
         }, this);
@@ -1045,18 +6765,170 @@ private:
     void loadSettings() {
         QSettings s("LiveTVPlayer", "LiveTVPlayer");
         m_currentCategory = s.value("lastCategory", "All").toString();
+        m_currentCategoryKind = s.value("lastCategoryKind",
+                                        m_currentCategory == "All" ? AllCategories : GroupCategory).toInt();
         m_volume = s.value("volume", 100).toInt();
         m_muted = s.value("muted", false).toBool();
+        m_audioOnlyPinned = s.value("audioOnly", false).toBool();
+        applyAudioOnly();
+        if (s.contains("bandwidthEstimate")) m_bandwidth.addRate(s.value("bandwidthEstimate").toDouble());
         m_lastStreamUrl = s.value("lastStream", "").toString();
+        m_lastStreamName = s.value("lastStreamName").toString();
+        m_lastStreamCategory = s.value("lastStreamCategory").toString();
+        m_proxyModel->setHideDead(s.value("hideDeadChannels", false).toBool());
+        m_previewGrabber->setEnabled(s.value("livePreviews", false).toBool());
+        updatePreviewActivity();
+        m_timeShiftCapacityMb = qMax(64, s.value("timeShiftCapacityMB", TIMESHIFT_DEFAULT_CAPACITY_MB).toInt());
+        m_recordDiskMBps = qMax(0, s.value("recordDiskMBps", RECORD_DEFAULT_DISK_MBPS).toInt());
+        m_recorder->setDiskRate(qint64(m_recordDiskMBps) * 1024 * 1024);
+
+        QVector<RecordingManager::Schedule> schedules;
+        int n = s.beginReadArray("recordingSchedules");
+        for (int i = 0; i < n; ++i) {
+            s.setArrayIndex(i);
+            RecordingManager::Schedule sched;
+            sched.url = s.value("url").toString();
+            sched.name = s.value("name").toString();
+            sched.start = s.value("start").toDateTime();
+            sched.stop = s.value("stop").toDateTime();
+            if (!sched.url.isEmpty() && sched.stop.isValid()) schedules.append(sched);
+        }
+        s.endArray();
+        QVector<RecordingManager::Schedule> missed = m_recorder->setSchedules(schedules);
+        if (!missed.isEmpty()) {
+            saveSchedules(s);
+            QStringList lines;
+            for (int i = 0; i < missed.size(); ++i) {
+                lines.append(QString("%1 (%2 - %3)")
+                                 .arg(missed[i].name,
+                                      missed[i].start.toString("yyyy-MM-dd HH:mm"),
+                                      missed[i].stop.toString("HH:mm")));
+            }
+            QTimer::singleShot(0, this, [this, lines]() {
+                QMessageBox::information(this, "Missed recordings",
+                                         "These scheduled recordings were missed while the player was closed:\n\n" +
+                                             lines.join("\n"));
+            });
+        }
+
+        QHash<QString, LogoDownloader::Failure> logoFailures;
+        n = s.beginReadArray("logoFailures");
+        for (int i = 0; i < n; ++i) {
+            s.setArrayIndex(i);
+            LogoDownloader::Failure f;
+            f.count = s.value("count").toInt();
+            f.retryAfter = s.value("retryAfter").toLongLong();
+            logoFailures.insert(s.value("url").toString(), f);
+        }
+        s.endArray();
+        m_logoDownloader->setFailures(logoFailures);
+
+        int sortIndex = m_sortCombo->findData(s.value("sortMode", CategoryFilterProxy::PlaylistOrder).toInt());
+        m_sortCombo->setCurrentIndex(qMax(0, sortIndex));
         updateVolumeLabel();
     }
 
+    void saveSchedules(QSettings &s) {
+        const QVector<RecordingManager::Schedule> &schedules = m_recorder->schedules();
+        s.remove("recordingSchedules");
+        s.beginWriteArray("recordingSchedules", schedules.size());
+        for (int i = 0; i < schedules.size(); ++i) {
+            s.setArrayIndex(i);
+            s.setValue("url", schedules[i].url);
+            s.setValue("name", schedules[i].name);
+            s.setValue("start", schedules[i].start);
+            s.setValue("stop", schedules[i].stop);
+        }
+        s.endArray();
+    }
+
     void saveSettings() {
         QSettings s("LiveTVPlayer", "LiveTVPlayer");
         s.setValue("lastCategory", m_currentCategory);
+        s.setValue("lastCategoryKind", m_currentCategoryKind);
         s.setValue("volume", m_volume);
         s.setValue("muted", m_muted);
-        if (!m_currentStreamUrl.isEmpty()) s.setValue("lastStream", m_currentStreamUrl);
+        s.setValue("audioOnly", m_audioOnlyPinned);
+        if (m_bandwidth.hasEstimate()) s.setValue("bandwidthEstimate", m_bandwidth.estimate());
+        s.setValue("hideDeadChannels", m_proxyModel->hideDead());
+        s.setValue("livePreviews", m_previewGrabber->isEnabled());
+        s.setValue("timeShiftCapacityMB", m_timeShiftCapacityMb);
+        s.setValue("recordDiskMBps", m_recordDiskMBps);
+        saveSchedules(s);
+
+        // Expired entries are kept so the back-off keeps growing; only a
+        // successful download clears one. Logos the current playlist no
+        // longer uses are dropped so the list does not grow forever.
+        const QHash<QString, LogoDownloader::Failure> &failures = m_logoDownloader->failures();
+        QSet<QString> logoUrls;
+        const QVector<Channel> &chans = m_channelModel->channels();
+        for (int i = 0; i < chans.size(); ++i) logoUrls.insert(chans[i].logoUrl);
+        s.remove("logoFailures");
+        s.beginWriteArray("logoFailures");
+        int written = 0;
+        for (auto it = failures.constBegin(); it != failures.constEnd(); ++it) {
+            if (!chans.isEmpty() && !logoUrls.contains(it.key())) continue;
+            s.setArrayIndex(written++);
+            s.setValue("url", it.key());
+            s.setValue("count", it->count);
+            s.setValue("retryAfter", it->retryAfter);
+        }
+        s.endArray();
+        s.setValue("sortMode", static_cast<int>(m_proxyModel->sortMode()));
+        s.setValue("mpvProfile", m_mpvProfile);
+        if (!m_currentStreamUrl.isEmpty()) {
+            s.setValue("lastStream", m_currentStreamUrl);
+            s.setValue("lastStreamName", m_currentChannelName);
+            s.setValue("lastStreamCategory", m_currentCategoryOfStream);
+        }
+    }
+
+    void resumeLastSession() {
+        if (!m_mpvOk || m_lastStreamUrl.isEmpty()) return;
+        m_pendingStreamUrl = m_lastStreamUrl;
+        m_pendingChannelName = m_lastStreamName.isEmpty() ? QString("Last channel") : m_lastStreamName;
+        m_pendingCategory = m_lastStreamCategory;
+        m_pendingRadio = isAudioStreamUrl(QUrl(m_lastStreamUrl));
+        m_pendingTvgId.clear();
+        m_pendingIndex = 0;
+        m_pendingTotal = 0;
+        doPlayChannel();
+        m_sessionResumed = true;
+        m_reconcilePending = true;
+    }
+
+    // Brings selection, mirror state and the OSD in line with a stream that
+    // started playing before the playlist was available.
+    void reconcileSession() {
+        if (m_currentStreamUrl.isEmpty()) return;
+        const QVector<Channel> &chans = m_channelModel->channels();
+        int sourceRow = -1;
+        for (int i = 0; i < chans.size() && sourceRow < 0; ++i) {
+            if (chans[i].streamUrl == m_currentStreamUrl) sourceRow = i;
+        }
+        if (sourceRow < 0) {
+            statusBar()->showMessage("The resumed channel is no longer in the playlist.", 5000);
+            return;
+        }
+        const Channel &ch = chans[sourceRow];
+        m_currentChannelName = ch.name;
+        m_currentCategoryOfStream = ch.category;
+        m_currentMirrorKey = m_mirrorKeyByUrl.value(ch.streamUrl);
+        m_currentIsRadio = ch.radio;
+        applyAudioOnly();
+        m_nowPlayingLabel->setText("  > " + m_currentChannelName);
+
+        QModelIndex idx = m_proxyModel->mapFromSource(m_channelModel->index(sourceRow, 0));
+        if (!idx.isValid()) return;
+        m_channelView->setCurrentIndex(idx);
+        m_channelView->scrollTo(idx, QAbstractItemView::PositionAtCenter);
+        if (m_osd) {
+            m_osd->showOsd(ch.name, ch.category, idx.row(), m_proxyModel->rowCount(), guideLines(ch.tvgId, ch.name));
+        }
+    }
+
+    static QString logoAtlasPath() {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/logo-atlas.bin";
     }
 
     void fetchPlaylist(const QString &urlStr) {
@@ -1066,29 +6938,9 @@ private:
         m_statusIndicator->setStatus(StatusIndicator::Connecting);
         statusBar()->showMessage("Loading playlist...");
 
-        QNetworkRequest req(url);
-        req.setRawHeader("User-Agent", "LiveTVPlayer/2.0");
-#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
-        req.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
-                         QNetworkRequest::NoLessSafeRedirectPolicy);
-#else
-        req.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
-#endif
-
-        QNetworkReply *reply = m_nam->get(req);
-
-        QTimer *timeout = new QTimer(this);
-        timeout->setSingleShot(true);
-        connect(timeout, &QTimer::timeout, this, [reply, timeout]() {
-            if (reply && reply->isRunning()) reply->abort();
-            timeout->deleteLater();
-        });
-        timeout->start(PLAYLIST_TIMEOUT_MS);
-
-        connect(reply, &QNetworkReply::finished, this, [this, reply, timeout]() {
-            timeout->stop();
-            timeout->deleteLater();
+        QNetworkReply *reply = m_net->get(NetworkLayer::request(url, PLAYLIST_TIMEOUT_MS));
 
+        connect(reply, &QNetworkReply::finished, this, [this, reply]() {
             if (reply->error() != QNetworkReply::NoError) {
                 m_statusIndicator->setStatus(StatusIndicator::Offline);
                 statusBar()->showMessage("Failed to load playlist: " + reply->errorString());
@@ -1116,109 +6968,199 @@ private:
     }
 
     void parseM3u(const QByteArray &data) {
-        QVector<Channel> channels;
-        QString text = QString::fromUtf8(data);
-        QStringList lines = text.split(QRegularExpression("[\\r\\n]+"), QString::SkipEmptyParts);
-
-        if (lines.isEmpty()) {
-            statusBar()->showMessage("Empty playlist.");
-            m_statusIndicator->setStatus(StatusIndicator::Offline);
-            return;
-        }
-
-        QRegularExpression reExtInf("^#EXTINF\\s*:\\s*(-?\\d+)\\s*(.*),\\s*(.*)$");
-        QRegularExpression reLogo("tvg-logo\\s*=\\s*\"([^\"]*)\"");
-        QRegularExpression reGroup("group-title\\s*=\\s*\"([^\"]*)\"");
-
-        Channel pending;
-        bool hasPending = false;
-
-        for (int i = 0; i < lines.size(); ++i) {
-            QString line = lines[i].trimmed();
-            if (line.isEmpty()) continue;
-
-            if (line.startsWith("#EXTINF")) {
-                QRegularExpressionMatch match = reExtInf.match(line);
-                pending = Channel();
-                if (match.hasMatch()) {
-                    QString attrs = match.captured(2);
-                    pending.name = match.captured(3).trimmed();
-                    if (pending.name.length() > MAX_NAME_LEN)
-                        pending.name = pending.name.left(MAX_NAME_LEN);
-
-                    QRegularExpressionMatch logoMatch = reLogo.match(attrs);
-                    if (logoMatch.hasMatch()) pending.logoUrl = logoMatch.captured(1).trimmed();
-
-                    QRegularExpressionMatch groupMatch = reGroup.match(attrs);
-                    if (groupMatch.hasMatch()) pending.category = groupMatch.captured(1).trimmed();
-                } else {
-                    int commaIdx = line.lastIndexOf(',');
-                    if (commaIdx >= 0) {
-                        pending.name = line.mid(commaIdx + 1).trimmed();
-                        if (pending.name.length() > MAX_NAME_LEN)
-                            pending.name = pending.name.left(MAX_NAME_LEN);
-                    }
-                }
-
-                if (pending.category.isEmpty()) pending.category = "Others";
-                if (pending.name.isEmpty()) pending.name = "Unknown";
-                hasPending = true;
-            } else if (!line.startsWith("#")) {
-                if (hasPending) {
-                    QUrl streamUrl(line);
-                    if (streamUrl.isValid()) {
-                        QString scheme = streamUrl.scheme().toLower();
-                        if (scheme == "http" || scheme == "https" || scheme == "rtsp" ||
-                            scheme == "rtmp" || scheme == "mms" || scheme == "mmsh") {
-                            pending.streamUrl = line;
-                            channels.append(pending);
-                        }
-                    }
-                    hasPending = false;
-                }
-            }
-        }
+        ProfileScope scope("MainWindow::parseM3u");
+        QVector<Channel> channels = parseM3uChannels(data);
 
         if (channels.isEmpty()) {
-            statusBar()->showMessage("No valid channels found in playlist.");
+            statusBar()->showMessage(data.trimmed().isEmpty() ? "Empty playlist." : "No valid channels found in playlist.");
             m_statusIndicator->setStatus(StatusIndicator::Offline);
             return;
         }
 
         m_channelModel->setChannels(channels);
+        m_proxyModel->rebuildSortKeys();
+        buildMirrorSets(channels);
 
         QSet<QString> catSet;
         for (int i = 0; i < channels.size(); ++i) catSet.insert(channels[i].category);
         QStringList cats = catSet.toList();
         std::sort(cats.begin(), cats.end());
-        cats.prepend("All");
 
         m_categoryList->blockSignals(true);
         m_categoryList->clear();
+        const struct { const char *text; int kind; } pseudo[] = {
+            {"All", AllCategories}, {"Favorites", FavoritesCategory}, {"Recent", RecentCategory}};
+        for (const auto &p : pseudo) {
+            QListWidgetItem *item = new QListWidgetItem(p.text);
+            item->setData(Qt::UserRole, p.kind);
+            m_categoryList->addItem(item);
+        }
         for (int i = 0; i < cats.size(); ++i) {
             QListWidgetItem *item = new QListWidgetItem(cats[i]);
+            item->setData(Qt::UserRole, int(GroupCategory));
             m_categoryList->addItem(item);
         }
         m_categoryList->blockSignals(false);
 
         int catIdx = 0;
-        if (!m_currentCategory.isEmpty()) {
-            for (int i = 0; i < m_categoryList->count(); ++i) {
-                if (m_categoryList->item(i)->text() == m_currentCategory) {
-                    catIdx = i;
-                    break;
-                }
+        for (int i = 0; i < m_categoryList->count(); ++i) {
+            QListWidgetItem *item = m_categoryList->item(i);
+            int kind = item->data(Qt::UserRole).toInt();
+            if (kind == m_currentCategoryKind && (kind != GroupCategory || item->text() == m_currentCategory)) {
+                catIdx = i;
+                break;
             }
         }
         m_categoryList->setCurrentRow(catIdx);
         onCategoryChanged(catIdx);
 
-        statusBar()->showMessage(QString("Loaded %1 channels in %2 categories").arg(channels.size()).arg(cats.size() - 1));
+        statusBar()->showMessage(QString("Loaded %1 channels in %2 categories").arg(channels.size()).arg(catSet.size()));
         if (m_currentStreamUrl.isEmpty()) {
             m_statusIndicator->setStatus(StatusIndicator::Online);
         }
         updateChannelCount();
         scheduleLogoDownloads();
+
+        QStringList streamUrls;
+        streamUrls.reserve(channels.size());
+        for (int i = 0; i < channels.size(); ++i) streamUrls.append(channels[i].streamUrl);
+        m_prober->setUrls(streamUrls);
+        m_visibleProbeTimer->start();
+        // Only the first playlist after a resume needs reconciling; a manual
+        // refresh must not move the selection or re-show the OSD.
+        if (m_reconcilePending) {
+            m_reconcilePending = false;
+            reconcileSession();
+        }
+        fetchGuide(parseM3uGuideUrl(data));
+    }
+
+    // A reloaded playlist replaces the guide, and one without a guide URL
+    // clears it so the OSD stops showing the old playlist's programmes.
+    void fetchGuide(const QString &urlStr) {
+        ++m_guideGeneration;
+        if (m_guideReply) {
+            QNetworkReply *superseded = m_guideReply;
+            m_guideReply = nullptr;
+            superseded->abort();
+        }
+        if (m_epgView->guide()) m_epgView->setGuide(EpgGuidePtr());
+        QUrl url(urlStr);
+        if (urlStr.isEmpty() || !url.isValid()) return;
+        QNetworkReply *reply = m_net->get(NetworkLayer::request(url, EPG_TIMEOUT_MS));
+        m_guideReply = reply;
+        // Guides can be huge; stop as soon as the cap is passed rather than
+        // buffering the whole body first.
+        connect(reply, &QNetworkReply::downloadProgress, this, [reply](qint64 received, qint64) {
+            if (received <= EPG_MAX_DOWNLOAD_SIZE || reply->property("tooLarge").toBool()) return;
+            reply->setProperty("tooLarge", true);
+            reply->abort();
+        });
+        connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+            reply->deleteLater();
+            if (reply != m_guideReply) return;
+            m_guideReply = nullptr;
+            if (reply->property("tooLarge").toBool()) {
+                statusBar()->showMessage("Programme guide too large.", 5000);
+                return;
+            }
+            if (reply->error() != QNetworkReply::NoError) {
+                statusBar()->showMessage("Failed to load programme guide: " + reply->errorString(), 5000);
+                return;
+            }
+            QByteArray data = reply->readAll();
+            QMetaObject::invokeMethod(m_epgLoader, "parse", Qt::QueuedConnection, Q_ARG(QByteArray, data),
+                                      Q_ARG(int, m_guideGeneration));
+        });
+    }
+
+    void onGuideParsed(EpgGuidePtr guide, int generation) {
+        if (generation != m_guideGeneration) return;
+        m_epgView->setGuide(guide);
+        if (guide->programmes.isEmpty()) return;
+        statusBar()->showMessage(QString("Programme guide loaded for %1 channels").arg(guide->programmes.size()), 5000);
+    }
+
+    // "Now" and "Next" lines for the OSD from the loaded programme guide.
+    QStringList guideLines(const QString &tvgId, const QString &name) const {
+        QStringList lines;
+        EpgGuidePtr guide = m_epgView->guide();
+        const QVector<Programme> *list = guide ? guideProgrammes(*guide, tvgId, name) : nullptr;
+        if (!list) return lines;
+        qint64 now = QDateTime::currentMSecsSinceEpoch();
+        for (const Programme &p : *list) {
+            if (p.stop <= now) continue;
+            bool airing = p.start <= now;
+            lines << QString("%1  %2  %3")
+                         .arg(airing ? "Now" : "Next", QDateTime::fromMSecsSinceEpoch(p.start).toString("HH:mm"), p.title);
+            if (!airing || lines.size() == 2) break;
+        }
+        return lines;
+    }
+
+    void buildMirrorSets(const QVector<Channel> &channels) {
+        m_mirrorSets.clear();
+        m_mirrorKeyByUrl.clear();
+        for (int i = 0; i < channels.size(); ++i) {
+            QString key = mirrorKey(channels[i]);
+            if (key.isEmpty()) continue;
+            QStringList &urls = m_mirrorSets[key];
+            if (!urls.contains(channels[i].streamUrl)) urls.append(channels[i].streamUrl);
+        }
+        QHash<QString, QStringList>::iterator it = m_mirrorSets.begin();
+        while (it != m_mirrorSets.end()) {
+            if (it->size() < 2) {
+                it = m_mirrorSets.erase(it);
+                continue;
+            }
+            for (int i = 0; i < it->size(); ++i) m_mirrorKeyByUrl.insert(it->at(i), it.key());
+            ++it;
+        }
+    }
+
+    QStringList rankedMirrors(const QString &key) const {
+        QStringList urls = m_mirrorSets.value(key);
+        auto healthRank = [this](const QString &url) {
+            switch (m_prober->liveness(url)) {
+                case StreamProber::Alive: return 0;
+                case StreamProber::Unknown: return 1;
+                default: return 2;
+            }
+        };
+        std::stable_sort(urls.begin(), urls.end(), [this, &healthRank](const QString &a, const QString &b) {
+            int ha = healthRank(a), hb = healthRank(b);
+            if (ha != hb) return ha < hb;
+            return m_zapLatency.value(a, DEFAULT_ZAP_LATENCY_MS) < m_zapLatency.value(b, DEFAULT_ZAP_LATENCY_MS);
+        });
+        return urls;
+    }
+
+    bool failoverToMirror(const QString &reason) {
+        if (m_currentMirrorKey.isEmpty()) return false;
+        m_triedMirrors.insert(m_currentStreamUrl);
+        QStringList candidates = rankedMirrors(m_currentMirrorKey);
+        for (int i = 0; i < candidates.size(); ++i) {
+            if (m_triedMirrors.contains(candidates[i])) continue;
+            m_currentStreamUrl = candidates[i];
+            m_watchdog->startSession(m_currentStreamUrl, m_currentChannelName);
+            m_statusIndicator->setStatus(StatusIndicator::Connecting);
+            statusBar()->showMessage(QString("%1: %2, trying mirror %3 of %4")
+                                         .arg(reason, m_currentChannelName)
+                                         .arg(m_triedMirrors.size() + 1)
+                                         .arg(candidates.size()));
+            playStream(m_currentStreamUrl);
+            return true;
+        }
+        return false;
+    }
+
+    void recordZapLatency(const QString &url, int ms) {
+        QHash<QString, int>::iterator it = m_zapLatency.find(url);
+        if (it == m_zapLatency.end()) {
+            m_zapLatency.insert(url, ms);
+        } else {
+            *it = (*it * 3 + ms) / 4;
+        }
     }
 
     void updateChannelCount() {
@@ -1233,76 +7175,33 @@ private:
     }
 
     void scheduleLogoDownloads() {
-        m_logoPending.clear();
-        m_activeLogoDownloads = 0;
-
         const QVector<Channel> &chans = m_channelModel->channels();
+        QStringList pending;
         QSet<QString> queued;
         for (int i = 0; i < chans.size(); ++i) {
             const Channel &ch = chans[i];
-            if (!ch.logoUrl.isEmpty() && !m_logoPixmaps.contains(ch.logoUrl) && !queued.contains(ch.logoUrl)) {
+            if (!ch.logoUrl.isEmpty() && !m_logoAtlas.contains(ch.logoUrl) && !queued.contains(ch.logoUrl)) {
                 QUrl u(ch.logoUrl);
                 if (u.isValid() && (u.scheme() == "http" || u.scheme() == "https")) {
-                    m_logoPending.append(ch.logoUrl);
+                    pending.append(ch.logoUrl);
                     queued.insert(ch.logoUrl);
                 }
             }
         }
-        downloadNextLogos();
+        m_logoDownloader->setUrls(pending);
     }
 
-    void downloadNextLogos() {
-        while (m_activeLogoDownloads < MAX_CONCURRENT_DOWNLOADS && !m_logoPending.isEmpty()) {
-            downloadLogo(m_logoPending.takeFirst());
+    void onLogoDownloaded(const QString &url, const QByteArray &data) {
+        ProfileScope scope("MainWindow::onLogoDownloaded");
+        if (m_memoryShed) {
+            m_deferredLogos.append(qMakePair(url, data));
+            return;
+        }
+        QImage image;
+        if (image.loadFromData(data)) m_logoAtlas.insert(url, image);
+        if (m_channelView && m_channelView->viewport()) {
+            m_channelView->viewport()->update();
         }
-    }
-
-    void downloadLogo(const QString &urlStr) {
-        QUrl url(urlStr);
-        if (!url.isValid()) return;
-
-        QNetworkRequest req(url);
-        req.setRawHeader("User-Agent", "LiveTVPlayer/2.0");
-#if QT_VERSION >= QT_VERSION_CHECK(5, 9, 0)
-        req.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
-                         QNetworkRequest::NoLessSafeRedirectPolicy);
-#else
-        req.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
-#endif
-
-        QNetworkReply *reply = m_logoNam->get(req);
-        m_activeLogoDownloads++;
-
-        QTimer *timeout = new QTimer(this);
-        timeout->setSingleShot(true);
-        connect(timeout, &QTimer::timeout, this, [reply, timeout]() {
-            if (reply && reply->isRunning()) reply->abort();
-            timeout->deleteLater();
-        });
-        timeout->start(IMAGE_TIMEOUT_MS);
-
-        connect(reply, &QNetworkReply::finished, this, [this, reply, urlStr, timeout]() {
-            timeout->stop();
-            timeout->deleteLater();
-            m_activeLogoDownloads--;
-
-            if (reply->error() == QNetworkReply::NoError) {
-                QByteArray imgData = reply->readAll();
-                if (imgData.size() < 2 * 1024 * 1024 && !imgData.isEmpty()) {
-                    QPixmap pm;
-                    if (pm.loadFromData(imgData)) {
-                        m_logoPixmaps.insert(urlStr, pm.scaled(52, 42, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-                    }
-                }
-            }
-
-            reply->deleteLater();
-            downloadNextLogos();
-
-            if (m_channelView && m_channelView->viewport()) {
-                m_channelView->viewport()->update();
-            }
-        });
     }
 
     void playStream(const QString &url) {
@@ -1311,6 +7210,35 @@ private:
             return;
         }
 
+        if (m_timeShift->isActive()) {
+            if (url == m_timeShift->sourceUrl()) {
+                loadUrl(m_timeShift->liveUrl());
+                return;
+            }
+            m_timeShift->stop();
+        }
+        loadUrl(m_relay->relayUrl(url));
+    }
+
+    void loadUrl(const QString &url) {
+        if (!m_mpvOk || !m_mpv || url.isEmpty()) return;
+
+        m_watchdog->onLoadStarted();
+        m_zapClock.start();
+
+        // Start well inside the measured bandwidth, or on the lowest variant
+        // before anything has been measured, so the first frame comes
+        // quickly; adaptVariant() steps up once the buffer allows. The lowest
+        // variant is often an audio-only rendition, which suits audio-only
+        // mode as it is.
+        QByteArray startRate = "min";
+        if (!m_audioOnly && m_bandwidth.hasEstimate())
+            startRate = QByteArray::number(qint64(m_bandwidth.estimate() * HLS_START_PERCENT / 100));
+        mpv_set_property_string(m_mpv, "hls-bitrate", startRate.constData());
+        m_variantStart = QString::fromLatin1(startRate);
+        m_variantClock.start();
+        m_cacheSeconds = 0;
+        m_awaitingFirstFrame = true;
         QByteArray urlBytes = url.toUtf8();
         const char *cmd[] = {"loadfile", urlBytes.constData(), "replace", NULL};
         int err = mpv_command(m_mpv, cmd);
@@ -1320,6 +7248,19 @@ private:
         }
     }
 
+    // Asks the relay to warm the streams at these proxy rows, wrapping like
+    // zapChannel() does. Dead streams and the one already playing are skipped.
+    void prewarmRows(const QVector<int> &rows) {
+        int total = m_proxyModel->rowCount();
+        if (total == 0) return;
+        for (int row : rows) {
+            QString url = m_proxyModel->index((row % total + total) % total, 0).data(StreamUrlRole).toString();
+            if (url.isEmpty() || url == m_currentStreamUrl) continue;
+            if (m_prober->liveness(url) == StreamProber::Dead) continue;
+            QMetaObject::invokeMethod(m_relay, "prewarm", Qt::QueuedConnection, Q_ARG(QString, url));
+        }
+    }
+
     void zapChannel(int direction) {
         if (!m_proxyModel || m_proxyModel->rowCount() == 0) return;
         int current = m_channelView->currentIndex().row();
@@ -1338,6 +7279,7 @@ private:
         if (m_mpv && m_mpvOk) {
             mpv_set_property_string(m_mpv, "volume", QString::number(m_volume).toUtf8().constData());
         }
+        m_mosaic->setVolume(m_volume);
         updateVolumeLabel();
         statusBar()->showMessage(QString("Volume: %1%").arg(m_volume), 2000);
     }
@@ -1347,6 +7289,7 @@ private:
         if (m_mpv && m_mpvOk) {
             mpv_set_property_string(m_mpv, "mute", m_muted ? "yes" : "no");
         }
+        m_mosaic->setMuted(m_muted);
         statusBar()->showMessage(m_muted ? "Muted" : "Unmuted", 2000);
     }
 
@@ -1356,14 +7299,26 @@ private:
         mpv_get_property(m_mpv, "pause", MPV_FORMAT_FLAG, &pause);
         pause = !pause;
         mpv_set_property(m_mpv, "pause", MPV_FORMAT_FLAG, &pause);
-        statusBar()->showMessage(pause ? "Paused" : "Playing", 2000);
+        if (m_timeShift->isActive()) {
+            showTimeShiftDelay(m_timeShift->liveEdgeMs() - timeShiftPositionMs());
+        } else {
+            statusBar()->showMessage(pause ? "Paused" : "Playing", 2000);
+        }
     }
 
     mpv_handle *m_mpv = nullptr;
     bool m_mpvOk = false;
 
-    QNetworkAccessManager *m_nam = nullptr;
-    QNetworkAccessManager *m_logoNam = nullptr;
+    NetworkLayer *m_net = nullptr;
+    LogoDownloader *m_logoDownloader = nullptr;
+    StreamProber *m_prober = nullptr;
+    SoftwareRenderer *m_swRenderer = nullptr;
+    QThread *m_relayThread = nullptr;
+    StreamRelay *m_relay = nullptr;
+    TimeShiftController *m_timeShift = nullptr;
+    RecordingManager *m_recorder = nullptr;
+    StartupOptions m_options;
+    QString m_playlistUrl;
 
     QWidget *m_headerBar = nullptr;
     QWidget *m_leftPanel = nullptr;
@@ -1374,36 +7329,90 @@ private:
     QPushButton *m_fullscreenBtn = nullptr;
     StatusIndicator *m_statusIndicator = nullptr;
     QListWidget *m_categoryList = nullptr;
-    QListView *m_channelView = nullptr;
+    ChannelGridView *m_channelView = nullptr;
+    QStackedWidget *m_browserStack = nullptr;
+    EpgView *m_epgView = nullptr;
+    PreviewGrabber *m_previewGrabber;
+    ActivityGovernor *m_governor;
+    bool m_memoryShed = false;
+    QVector<QPair<QString, QByteArray> > m_deferredLogos;
+    QThread *m_epgThread;
+    EpgLoader *m_epgLoader;
+    QPointer<QNetworkReply> m_guideReply;
+    int m_guideGeneration = 0;
     VideoWidget *m_videoWidget = nullptr;
-    OsdWidget *m_osd = nullptr;
+    QStackedWidget *m_videoStack = nullptr;
+    MosaicView *m_mosaic = nullptr;
+    OsdOverlay *m_osd = nullptr;
+    ProfilerOverlay *m_profilerOverlay = nullptr;
+    QTimer *m_lagTimer = nullptr;
+    qint64 m_lagLastNs = 0;
     QSplitter *m_vertSplitter = nullptr;
 
     ChannelModel *m_channelModel = nullptr;
     CategoryFilterProxy *m_proxyModel = nullptr;
     ChannelDelegate *m_delegate = nullptr;
 
-    QHash<QString, QPixmap> m_logoPixmaps;
-    QStringList m_logoPending;
-    int m_activeLogoDownloads = 0;
+    LogoAtlas m_logoAtlas;
+    HistoryStore *m_history;
+    QTimer *m_watchFlushTimer;
+    QElapsedTimer m_watchClock;
+    QString m_watchUrl;
+    QComboBox *m_sortCombo = nullptr;
 
     QTimer *m_debounceTimer = nullptr;
     QTimer *m_autoHideTimer = nullptr;
     QTimer *m_searchDebounce = nullptr;
     QTimer *m_statusCheckTimer = nullptr;
+    QTimer *m_probeRepaintTimer = nullptr;
+    QTimer *m_visibleProbeTimer = nullptr;
+    QTimer *m_prewarmTimer = nullptr;
+    int m_prewarmRow = -1;
+    PlaybackWatchdog *m_watchdog = nullptr;
+    QualityLog m_qualityLog;
+
+    QHash<QString, QStringList> m_mirrorSets;
+    QHash<QString, QString> m_mirrorKeyByUrl;
+    QHash<QString, int> m_zapLatency;
+    QSet<QString> m_triedMirrors;
+    QString m_currentMirrorKey;
+    QElapsedTimer m_zapClock;
+    BandwidthEstimator m_bandwidth;
+    QString m_variantStart;
+    QElapsedTimer m_variantClock;
+    QElapsedTimer m_adaptClock;
+    QElapsedTimer m_rateSampleClock;
+    double m_cacheSeconds = 0;
+    bool m_awaitingFirstFrame = false;
 
     QString m_pendingStreamUrl;
     QString m_pendingChannelName;
     QString m_pendingCategory;
+    bool m_pendingRadio = false;
+    QString m_pendingTvgId;
+    bool m_currentIsRadio = false;
+    bool m_audioOnlyPinned = false;
+    bool m_inBackground = false;
+    bool m_audioOnly = false;
     int m_pendingIndex = 0;
     int m_pendingTotal = 0;
 
     QString m_currentChannelName;
     QString m_currentStreamUrl;
     QString m_currentCategory;
+    int m_currentCategoryKind = AllCategories;
     QString m_lastStreamUrl;
+    QString m_lastStreamName;
+    QString m_lastStreamCategory;
+    QString m_currentCategoryOfStream;
+    QString m_mpvProfile;
+    bool m_firstFrameReported = false;
+    bool m_sessionResumed = false;
+    bool m_reconcilePending = false;
 
     int m_volume = 100;
+    int m_timeShiftCapacityMb = TIMESHIFT_DEFAULT_CAPACITY_MB;
+    int m_recordDiskMBps = RECORD_DEFAULT_DISK_MBPS;
     bool m_muted = false;
     bool m_isFullscreen = false;
     QByteArray m_savedSplitterState;
@@ -1414,14 +7423,598 @@ private:
 #ifdef Q_OS_WIN
 #include <QtPlugin>
 Q_IMPORT_PLUGIN(QWindowsIntegrationPlugin)
+#ifdef LIVETV_HEADLESS
+// The console build CI runs --selftest and --bench with, on -platform minimal.
+Q_IMPORT_PLUGIN(QMinimalIntegrationPlugin)
 #endif
+#endif
+
+// Headless benchmark of the playlist pipeline: fetch from a loopback HTTP
+// fixture, parse, populate the model, filter and paint cards, on generated
+// playlists of increasing size. Run with --bench, plus
+// QT_QPA_PLATFORM=offscreen where there is no display.
+static QByteArray generatePlaylist(int channels) {
+    QByteArray out = "#EXTM3U\n";
+    out.reserve(channels * 200);
+    for (int i = 0; i < channels; ++i) {
+        QByteArray n = QByteArray::number(i);
+        out += "#EXTINF:-1 tvg-id=\"ch" + n + "\" tvg-chno=\"" + QByteArray::number(channels - i) + "\" tvg-logo=\"http://logos.invalid/" + QByteArray::number(i % 5000) +
+               ".png\" group-title=\"Group " + QByteArray::number(i % 40) + "\",Channel " + n +
+               (i % 3 == 0 ? " HD\n" : "\n");
+        out += "http://streams.invalid/live/" + n + ".m3u8\n";
+    }
+    return out;
+}
+
+static QByteArray fetchFromFixture(NetworkLayer *net, const QByteArray &body, qint64 *elapsedMs) {
+    QTcpServer server;
+    if (!server.listen(QHostAddress::LocalHost, 0)) return QByteArray();
+    QObject::connect(&server, &QTcpServer::newConnection, [&server, &body]() {
+        while (QTcpSocket *sock = server.nextPendingConnection()) {
+            QObject::connect(sock, &QTcpSocket::disconnected, sock, &QObject::deleteLater);
+            QObject::connect(sock, &QTcpSocket::readyRead, sock, [sock, &body]() {
+                QByteArray request = sock->property("request").toByteArray() + sock->readAll();
+                sock->setProperty("request", request);
+                if (!request.contains("\r\n\r\n")) return;
+                sock->write("HTTP/1.1 200 OK\r\nContent-Type: audio/x-mpegurl\r\nContent-Length: " +
+                            QByteArray::number(body.size()) + "\r\nConnection: close\r\n\r\n");
+                sock->write(body);
+                sock->disconnectFromHost();
+            });
+        }
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    QUrl url(QString("http://127.0.0.1:%1/playlist.m3u").arg(server.serverPort()));
+    QNetworkReply *reply = net->get(NetworkLayer::request(url, PLAYLIST_TIMEOUT_MS));
+    QEventLoop loop;
+    QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+    *elapsedMs = timer.elapsed();
+    QByteArray data = reply->readAll();
+    reply->deleteLater();
+    return data;
+}
+
+// The application stylesheet exactly as applyModernTheme() set it before
+// ModernStyle replaced it, so the benchmark compares against what shipped.
+static const char *const THEME_BENCH_STYLESHEET =
+    "* {"
+    "  font-family: 'Segoe UI', 'SF Pro Display', 'Helvetica Neue', Arial, sans-serif;"
+    "}"
+    "QMainWindow, QWidget {"
+    "  background-color: #0f0f1a;"
+    "  color: #e2e8f0;"
+    "}"
+    "#headerBar {"
+    "  background: qlineargradient(x1:0, y1:0, x2:0, y2:1,"
+    "    stop:0 #1a1a2e, stop:1 #16162a);"
+    "  border-bottom: 1px solid rgba(255,255,255,0.06);"
+    "}"
+    "#appTitle {"
+    "  font-size: 16px;"
+    "  font-weight: 700;"
+    "  color: #f1f5f9;"
+    "}"
+    "#searchEdit {"
+    "  background-color: #1e1e35;"
+    "  color: #e2e8f0;"
+    "  border: 1px solid rgba(255,255,255,0.1);"
+    "  border-radius: 8px;"
+    "  padding: 6px 12px;"
+    "  font-size: 13px;"
+    "  selection-background-color: #6366f1;"
+    "}"
+    "#searchEdit:focus {"
+    "  border: 1px solid #6366f1;"
+    "  background-color: #222240;"
+    "}"
+    "#sortCombo {"
+    "  background-color: #1e1e35;"
+    "  color: #e2e8f0;"
+    "  border: 1px solid rgba(255,255,255,0.1);"
+    "  border-radius: 8px;"
+    "  padding: 5px 10px;"
+    "  font-size: 12px;"
+    "}"
+    "#sortCombo QAbstractItemView {"
+    "  background-color: #1e1e35;"
+    "  color: #e2e8f0;"
+    "  selection-background-color: #6366f1;"
+    "}"
+    "#nowPlaying {"
+    "  color: #a5b4fc;"
+    "  font-size: 12px;"
+    "  font-weight: 600;"
+    "}"
+    "#channelCount {"
+    "  color: #64748b;"
+    "  font-size: 11px;"
+    "}"
+    "#volumeLabel {"
+    "  color: #94a3b8;"
+    "  font-size: 11px;"
+    "  font-weight: 600;"
+    "}"
+    "#iconBtn {"
+    "  background: rgba(255,255,255,0.05);"
+    "  border: 1px solid rgba(255,255,255,0.08);"
+    "  border-radius: 6px;"
+    "  color: #e2e8f0;"
+    "  font-size: 14px;"
+    "}"
+    "#iconBtn:hover {"
+    "  background: rgba(99,102,241,0.3);"
+    "  border-color: rgba(99,102,241,0.5);"
+    "}"
+    "#iconBtn:pressed {"
+    "  background: rgba(99,102,241,0.5);"
+    "}"
+    "#headerSep {"
+    "  background-color: rgba(255,255,255,0.04);"
+    "  border: none;"
+    "}"
+    "#leftPanel {"
+    "  background-color: #12121f;"
+    "  border-right: 1px solid rgba(255,255,255,0.04);"
+    "}"
+    "#sectionTitle {"
+    "  font-weight: 700;"
+    "  font-size: 13px;"
+    "  color: #94a3b8;"
+    "  text-transform: uppercase;"
+    "  letter-spacing: 1px;"
+    "  padding: 4px 8px;"
+    "}"
+    "#categoryList {"
+    "  background-color: transparent;"
+    "  border: none;"
+    "  outline: none;"
+    "  font-size: 13px;"
+    "}"
+    "#categoryList::item {"
+    "  padding: 8px 12px;"
+    "  border-radius: 8px;"
+    "  margin: 1px 4px;"
+    "  color: #cbd5e1;"
+    "}"
+    "#categoryList::item:selected {"
+    "  background: qlineargradient(x1:0, y1:0, x2:1, y2:0,"
+    "    stop:0 rgba(99,102,241,0.35), stop:1 rgba(99,102,241,0.15));"
+    "  color: #e0e7ff;"
+    "  border-left: 3px solid #6366f1;"
+    "}"
+    "#categoryList::item:hover:!selected {"
+    "  background-color: rgba(255,255,255,0.04);"
+    "}"
+    "#refreshBtn {"
+    "  background: rgba(99,102,241,0.15);"
+    "  border: 1px solid rgba(99,102,241,0.25);"
+    "  border-radius: 8px;"
+    "  color: #a5b4fc;"
+    "  padding: 8px;"
+    "  font-size: 12px;"
+    "  font-weight: 600;"
+    "}"
+    "#refreshBtn:hover {"
+    "  background: rgba(99,102,241,0.3);"
+    "  color: #e0e7ff;"
+    "}"
+    "#channelGrid {"
+    "  background-color: #0f0f1a;"
+    "  border: none;"
+    "  border-top: 1px solid rgba(255,255,255,0.04);"
+    "}"
+    "QSplitter::handle {"
+    "  background-color: rgba(255,255,255,0.04);"
+    "}"
+    "QSplitter::handle:horizontal { width: 1px; }"
+    "QSplitter::handle:vertical { height: 4px; }"
+    "QSplitter::handle:hover {"
+    "  background-color: rgba(99,102,241,0.4);"
+    "}"
+    "QStatusBar {"
+    "  background-color: #0a0a16;"
+    "  color: #64748b;"
+    "  font-size: 11px;"
+    "  border-top: 1px solid rgba(255,255,255,0.04);"
+    "  padding: 2px 12px;"
+    "}"
+    "QScrollBar:vertical {"
+    "  background: transparent;"
+    "  width: 8px;"
+    "  margin: 0;"
+    "}"
+    "QScrollBar::handle:vertical {"
+    "  background: rgba(148,163,184,0.2);"
+    "  border-radius: 4px;"
+    "  min-height: 30px;"
+    "}"
+    "QScrollBar::handle:vertical:hover {"
+    "  background: rgba(148,163,184,0.35);"
+    "}"
+    "QScrollBar::add-line:vertical, QScrollBar::sub-line:vertical {"
+    "  height: 0;"
+    "}"
+    "QScrollBar::add-page:vertical, QScrollBar::sub-page:vertical {"
+    "  background: transparent;"
+    "}";
+
+// The main window's chrome without the video and channel grid: header,
+// category panel and status bar, named as in MainWindow::setupUi().
+static QWidget *buildThemeFixture() {
+    QWidget *root = new QWidget;
+    root->resize(1280, 720);
+    QVBoxLayout *rootLayout = new QVBoxLayout(root);
+    rootLayout->setContentsMargins(0, 0, 0, 0);
+    rootLayout->setSpacing(0);
+
+    HeaderBar *header = new HeaderBar(root);
+    header->setObjectName("headerBar");
+    header->setFixedHeight(52);
+    QHBoxLayout *headerLayout = new QHBoxLayout(header);
+    QLabel *title = new QLabel("Live TV", header);
+    title->setObjectName("appTitle");
+    headerLayout->addWidget(title);
+    QLineEdit *search = new QLineEdit(header);
+    search->setObjectName("searchEdit");
+    search->setPlaceholderText("Search channels...");
+    headerLayout->addWidget(search);
+    QComboBox *sort = new QComboBox(header);
+    sort->setObjectName("sortCombo");
+    sort->addItems({"Playlist order", "Name", "Channel number", "Most watched", "Recently watched"});
+    headerLayout->addWidget(sort);
+    headerLayout->addStretch();
+    QLabel *nowPlaying = new QLabel("  No channel selected", header);
+    nowPlaying->setObjectName("nowPlaying");
+    headerLayout->addWidget(nowPlaying);
+    QLabel *count = new QLabel("50000 channels", header);
+    count->setObjectName("channelCount");
+    headerLayout->addWidget(count);
+    for (const char *label : {"-", "+", "+"}) {
+        QPushButton *button = new QPushButton(label, header);
+        button->setObjectName("iconBtn");
+        button->setFixedSize(32, 32);
+        headerLayout->addWidget(button);
+    }
+    rootLayout->addWidget(header);
+
+    QFrame *sep = new QFrame(root);
+    sep->setFrameShape(QFrame::HLine);
+    sep->setObjectName("headerSep");
+    sep->setFixedHeight(1);
+    rootLayout->addWidget(sep);
+
+    QSplitter *splitter = new QSplitter(Qt::Horizontal, root);
+    QWidget *leftPanel = new QWidget(splitter);
+    leftPanel->setObjectName("leftPanel");
+    leftPanel->setFixedWidth(200);
+    QVBoxLayout *leftLayout = new QVBoxLayout(leftPanel);
+    QLabel *section = new QLabel("Categories", leftPanel);
+    section->setObjectName("sectionTitle");
+    leftLayout->addWidget(section);
+    QListWidget *categories = new QListWidget(leftPanel);
+    categories->setObjectName("categoryList");
+    for (int i = 0; i < 60; ++i) categories->addItem(QString("Group %1").arg(i));
+    categories->setCurrentRow(3);
+    leftLayout->addWidget(categories);
+    QPushButton *refresh = new QPushButton("Refresh Playlist", leftPanel);
+    refresh->setObjectName("refreshBtn");
+    leftLayout->addWidget(refresh);
+    splitter->addWidget(leftPanel);
+    splitter->addWidget(new QWidget(splitter));
+    rootLayout->addWidget(splitter, 1);
+
+    QStatusBar *status = new QStatusBar(root);
+    status->showMessage("Playing: Channel 12");
+    rootLayout->addWidget(status);
+    return root;
+}
+
+// Builds and polishes the fixture, then repaints it, once under the old
+// stylesheet and once under ModernStyle alone.
+static void benchTheme(QTextStream &out) {
+    out << QString("\n%1 %2 %3\n").arg("theme", 11).arg("build_ms", 9).arg("repaint_ms", 11);
+    const int rounds = 20;
+    for (int pass = 0; pass < 2; ++pass) {
+        bool stylesheet = pass == 0;
+        qApp->setStyleSheet(stylesheet ? QString::fromLatin1(THEME_BENCH_STYLESHEET) : QString());
+
+        QElapsedTimer timer;
+        timer.start();
+        QWidget *fixture = buildThemeFixture();
+        fixture->ensurePolished();
+        for (QWidget *child : fixture->findChildren<QWidget *>()) child->ensurePolished();
+        fixture->layout()->activate();
+        double buildMs = timer.nsecsElapsed() / 1e6;
+
+        timer.restart();
+        for (int round = 0; round < rounds; ++round) fixture->grab();
+        double repaintMs = timer.nsecsElapsed() / 1e6 / rounds;
+        delete fixture;
+
+        out << QString("%1 %2 %3\n")
+                   .arg(stylesheet ? "stylesheet" : "proxy-style", 11)
+                   .arg(buildMs, 9, 'f', 2)
+                   .arg(repaintMs, 11, 'f', 2);
+        out.flush();
+    }
+    qApp->setStyleSheet(QString());
+}
+
+static int runBenchmarks() {
+    QTextStream out(stdout);
+    NetworkLayer net;
+    LogoAtlas atlas(1.0);
+    for (int i = 0; i < 200; ++i) {
+        QImage logo(128, 96, QImage::Format_ARGB32_Premultiplied);
+        logo.fill(QColor::fromHsv((i * 37) % 360, 160, 200));
+        atlas.insert(QString("http://logos.invalid/%1.png").arg(i), logo);
+    }
+    ChannelDelegate delegate;
+    delegate.setLogoAtlas(&atlas);
+
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10 %11 %12\n")
+               .arg("channels", 9).arg("fetch_ms", 9).arg("parse_ms", 9).arg("parse_MB/s", 11)
+               .arg("model_ms", 9).arg("cat_ms", 8).arg("search_ms", 10).arg("clear_ms", 9)
+               .arg("keys_ms", 9).arg("sort_ms", 9).arg("paint_us", 9).arg("rss_MB", 8);
+    out.flush();
+
+    const int sizes[] = {1000, 50000, 500000};
+    for (int size : sizes) {
+        QByteArray playlist = generatePlaylist(size);
+        qint64 fetchMs = 0;
+        QByteArray data = fetchFromFixture(&net, playlist, &fetchMs);
+        if (data.size() != playlist.size()) {
+            out << "fixture fetch failed for " << size << " channels\n";
+            return 1;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        QVector<Channel> channels = parseM3uChannels(data);
+        double parseMs = timer.nsecsElapsed() / 1e6;
+        if (channels.size() != size) {
+            out << "parsed " << channels.size() << " of " << size << " channels\n";
+            return 1;
+        }
+
+        ChannelModel model;
+        CategoryFilterProxy proxy;
+        proxy.setSourceModel(&model);
+        timer.restart();
+        model.setChannels(channels);
+        double modelMs = timer.nsecsElapsed() / 1e6;
+
+        timer.restart();
+        proxy.setCategoryFilter("Group 7");
+        double categoryMs = timer.nsecsElapsed() / 1e6;
+        timer.restart();
+        proxy.setSearchFilter("channel 12");
+        double searchMs = timer.nsecsElapsed() / 1e6;
+        timer.restart();
+        proxy.setCategoryFilter(QString());
+        proxy.setSearchFilter(QString());
+        double clearMs = timer.nsecsElapsed() / 1e6;
+
+        timer.restart();
+        proxy.rebuildSortKeys();
+        double keysMs = timer.nsecsElapsed() / 1e6;
+        // Both are ranked modes, so the second switch must re-sort as well.
+        timer.restart();
+        proxy.setSortMode(CategoryFilterProxy::SortByNumber);
+        proxy.setSortMode(CategoryFilterProxy::SortByName);
+        double sortMs = timer.nsecsElapsed() / 1e6 / 2;
+
+        // One screenful of cards, painted repeatedly.
+        QImage canvas(1280, 720, QImage::Format_ARGB32_Premultiplied);
+        QPainter painter(&canvas);
+        QStyleOptionViewItem option;
+        option.state = QStyle::State_Enabled;
+        int cards = qMin(proxy.rowCount(), 42);
+        const int rounds = 20;
+        timer.restart();
+        for (int round = 0; round < rounds; ++round) {
+            for (int i = 0; i < cards; ++i) {
+                option.rect = QRect((i % 7) * 184, (i / 7) * 112, 172, 100);
+                delegate.paint(&painter, option, proxy.index(i, 0));
+            }
+        }
+        double paintUs = cards > 0 ? timer.nsecsElapsed() / 1e3 / (rounds * cards) : 0.0;
+        painter.end();
+
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9 %10 %11 %12\n")
+                   .arg(channels.size(), 9)
+                   .arg(fetchMs, 9)
+                   .arg(parseMs, 9, 'f', 1)
+                   .arg(data.size() / 1048576.0 / (parseMs / 1000.0), 11, 'f', 1)
+                   .arg(modelMs, 9, 'f', 2)
+                   .arg(categoryMs, 8, 'f', 2)
+                   .arg(searchMs, 10, 'f', 2)
+                   .arg(clearMs, 9, 'f', 2)
+                   .arg(keysMs, 9, 'f', 1)
+                   .arg(sortMs, 9, 'f', 1)
+                   .arg(paintUs, 9, 'f', 1)
+                   .arg(processRssBytes() / 1048576.0, 8, 'f', 1);
+        out.flush();
+    }
+    benchTheme(out);
+    return 0;
+}
+
+// Functional checks run by CI with --selftest. Each failed check prints a
+// line; the exit code is the number of failures.
+static int g_selfTestFailures = 0;
+
+static void selfCheck(bool ok, const char *what) {
+    if (ok) return;
+    ++g_selfTestFailures;
+    QTextStream(stdout) << "FAIL: " << what << "\n";
+}
+
+static void testParseM3u() {
+    QVector<Channel> chans = parseM3uChannels(
+        "#EXTM3U url-tvg=\"http://guide.invalid/epg.xml\"\r\n"
+        "#EXTINF:-1 tvg-id=\"one.tv\" tvg-chno=\"7\" tvg-logo=\"http://logo.invalid/1.png\" group-title=\"News\",One HD\r\n"
+        "http://streams.invalid/one.m3u8\r\n"
+        "#EXTINF:-1 radio=\"true\",Two FM\n"
+        "rtmp://streams.invalid/two\n"
+        "#EXTINF:-1 group-title=\"Music\",\n"
+        "http://streams.invalid/three.mp3\n"
+        "#EXTINF:-1,Dropped\n"
+        "file:///etc/passwd\n"
+        "http://streams.invalid/orphan.ts\n");
+    selfCheck(chans.size() == 3, "parseM3uChannels keeps only stream schemes with an #EXTINF");
+    if (chans.size() != 3) return;
+    selfCheck(chans[0].name == "One HD" && chans[0].tvgId == "one.tv" && chans[0].number == 7, "EXTINF attributes");
+    selfCheck(chans[0].category == "News" && chans[0].logoUrl == "http://logo.invalid/1.png", "group and logo");
+    selfCheck(!chans[0].radio, "video channel is not radio");
+    selfCheck(chans[1].radio && chans[1].category == DEFAULT_CATEGORY, "radio attribute and default group");
+    selfCheck(chans[2].name == UNNAMED_CHANNEL && chans[2].radio, "placeholder name and audio suffix");
+    selfCheck(mirrorKey(chans[2]).isEmpty(), "placeholder names have no mirror key");
+    selfCheck(parseM3uChannels("\r\n\r\n").isEmpty(), "empty playlist");
+}
+
+static void testCategoryProxy() {
+    QVector<Channel> chans;
+    const char *titles[] = {"Zeta", "alpha 10", "Alpha 9", "Beta"};
+    const int numbers[] = {2, 0, 3, 1};
+    for (int i = 0; i < 4; ++i) {
+        Channel c;
+        c.name = titles[i];
+        c.category = i % 2 ? "Movies" : "News";
+        c.streamUrl = QString("http://streams.invalid/%1").arg(i);
+        c.number = numbers[i];
+        chans.append(c);
+    }
+    ChannelModel model;
+    CategoryFilterProxy proxy;
+    proxy.setSourceModel(&model);
+    model.setChannels(chans);
+    proxy.rebuildSortKeys();
+
+    auto listed = [&proxy]() {
+        QStringList out;
+        for (int i = 0; i < proxy.rowCount(); ++i) out << proxy.index(i, 0).data(NameRole).toString();
+        return out.join(",");
+    };
+    selfCheck(listed() == "Zeta,alpha 10,Alpha 9,Beta", "playlist order");
+    proxy.setSortMode(CategoryFilterProxy::SortByName);
+    selfCheck(listed() == "Alpha 9,alpha 10,Beta,Zeta", "natural, case-insensitive name order");
+    proxy.setSortMode(CategoryFilterProxy::SortByNumber);
+    selfCheck(listed() == "Beta,Zeta,Alpha 9,alpha 10", "number order, unnumbered last");
+    proxy.setCategoryFilter("News");
+    selfCheck(listed() == "Zeta,Alpha 9", "category filter keeps sort order");
+    proxy.setCategoryFilter(QString());
+    proxy.setSearchFilter("ALPHA");
+    selfCheck(listed() == "Alpha 9,alpha 10", "case-insensitive search");
+    proxy.setSearchFilter(QString());
+
+    // A reloaded playlist must not be sorted with the old ranks.
+    chans.removeFirst();
+    model.setChannels(chans);
+    proxy.rebuildSortKeys();
+    selfCheck(listed() == "Beta,Alpha 9,alpha 10", "re-sorted after reload");
+}
+
+static void testRewriteManifest() {
+    StreamRelay relay;
+    relay.start();
+    QByteArray out = relay.rewriteManifest(QUrl("http://cdn.invalid/live/index.m3u8"),
+                                           "#EXTM3U\n"
+                                           "#EXT-X-KEY:METHOD=AES-128,URI=\"keys/k1\"\n"
+                                           "#EXTINF:6.0,\n"
+                                           "seg1.ts\n"
+                                           "http://other.invalid/seg2.ts\n");
+    QList<QByteArray> lines = out.split('\n');
+    selfCheck(lines.size() >= 5 && lines[0] == "#EXTM3U" && lines[2] == "#EXTINF:6.0,", "tags pass through");
+    if (lines.size() < 5) return;
+    selfCheck(lines[1].contains("URI=\"" + relay.relayUrl("http://cdn.invalid/live/keys/k1").toUtf8() + "\""),
+              "tag URIs resolved and relayed");
+    selfCheck(lines[3] == relay.relayUrl("http://cdn.invalid/live/seg1.ts").toUtf8(), "relative segment relayed");
+    selfCheck(lines[3].startsWith("http://127.0.0.1:"), "segment points at the relay");
+    selfCheck(lines[4] == relay.relayUrl("http://other.invalid/seg2.ts").toUtf8(), "absolute segment relayed");
+    relay.stop();
+}
+
+static void testTimeShiftRing() {
+    QString path = QDir::temp().filePath(QString("timeshift-selftest-%1.bin").arg(QCoreApplication::applicationPid()));
+    TimeShiftRing ring;
+    selfCheck(ring.open(path, 64), "ring opens");
+    QByteArray data;
+    for (int i = 0; i < 100; ++i) data += char(i);
+    selfCheck(ring.write(data.left(40)) && ring.write(data.mid(40)), "ring writes");
+    selfCheck(ring.writePos() == 100 && ring.oldestPos() == 36, "positions after wraparound");
+
+    QAtomicInt cancel;
+    qint64 pos = 0;
+    char buf[128];
+    QByteArray got;
+    while (got.size() < 64) {
+        qint64 n = ring.read(&pos, buf, sizeof(buf), &cancel);
+        if (n <= 0) break;
+        got.append(buf, static_cast<int>(n));
+    }
+    selfCheck(got == data.mid(36), "lapped reader skips to the oldest byte and reads across the wrap");
+    ring.shutdown();
+    selfCheck(ring.read(&pos, buf, sizeof(buf), &cancel) == 0, "end of stream after shutdown");
+}
+
+static void testRecordingExtension() {
+    QByteArray ts(376, '\0');
+    ts[0] = 0x47;
+    ts[188] = 0x47;
+    selfCheck(recordingExtension(ts) == "ts", "MPEG-TS recorded as .ts");
+    QByteArray id3("ID3\x04\0\0\0\0\0\0", 10);
+    selfCheck(recordingExtension(id3 + QByteArray("\xff\xf1\x50\x80", 4)) == "aac", "packed ADTS recorded as .aac");
+    selfCheck(recordingExtension(QByteArray("\xff\xfb\x90\x00", 4)) == "mp3", "MPEG audio recorded as .mp3");
+    selfCheck(recordingExtension(QByteArray("\0\0\0\x18" "ftypmp42", 12)) == "mp4", "ISO BMFF recorded as .mp4");
+}
+
+static int runSelfTests() {
+    testParseM3u();
+    testCategoryProxy();
+    testRewriteManifest();
+    testTimeShiftRing();
+    testRecordingExtension();
+    QTextStream(stdout) << (g_selfTestFailures ? "self-test failed\n" : "self-test passed\n");
+    return g_selfTestFailures;
+}
 
 int main(int argc, char *argv[]) {
+    StartupOptions options;
+    options.launchClock.start();
     QApplication app(argc, argv);
     app.setApplicationName("LiveTVPlayer");
     app.setOrganizationName("LiveTVPlayer");
 
-    MainWindow w;
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption playlistOpt("playlist", "Load the M3U playlist from <url>.", "url", PLAYLIST_URL);
+    QCommandLineOption swRenderOpt("sw-render", "Render video in software through the mpv render API.");
+    QCommandLineOption renderScaleOpt("render-scale", "Software render resolution relative to the window (0.1-1.0).",
+                                      "scale", "1.0");
+    QCommandLineOption benchOpt("bench", "Run the playlist pipeline and theme benchmarks and exit.");
+    QCommandLineOption selfTestOpt("selftest", "Run the functional self-checks and exit non-zero on failure.");
+    parser.addOption(playlistOpt);
+    parser.addOption(swRenderOpt);
+    parser.addOption(renderScaleOpt);
+    parser.addOption(benchOpt);
+    parser.addOption(selfTestOpt);
+    parser.process(app);
+
+    ModernStyle::install();
+    if (parser.isSet(selfTestOpt)) return runSelfTests();
+    if (parser.isSet(benchOpt)) return runBenchmarks();
+
+    // Headless platforms have no window for mpv to embed into.
+    QString platform = QGuiApplication::platformName();
+    options.playlistUrl = parser.value(playlistOpt);
+    options.softwareRender = parser.isSet(swRenderOpt) || platform == "offscreen" || platform == "minimal";
+    options.renderScale = qBound(0.1, parser.value(renderScaleOpt).toDouble(), 1.0);
+
+    MainWindow w(options);
     w.show();
 
     return app.exec();